@@ -0,0 +1,90 @@
+#pragma once
+#include "graph.hpp"
+#include "parallel.hpp"
+#include "dijkstra.hpp"
+#include "../lib/json.hpp"
+#include <queue>
+#include <vector>
+#include <cstdint>
+#include <chrono>
+#include <stdexcept>
+
+using json = nlohmann::json;
+using namespace std;
+
+// Walking distance and next hop between every pair of nodes, for small campuses:
+// a route is then read off the table in O(path length). Built by one Dijkstra
+// per source spread over all cores, which on sparse footpath graphs is far
+// cheaper than Floyd-Warshall's n^3. Takes 8 bytes per node pair.
+class AllPairsTable {
+private:
+    uint64_t version = 0;
+    int n = 0;
+    vector<int32_t> dist;  // dist[s * n + t], INF if unreachable
+    vector<int32_t> next;  // first node after s on a shortest path to t
+
+    // Distances and first hops from one source into row s of both tables
+    void fillRow(const Graph& g, int s) {
+        int32_t* rowDist = &dist[(size_t)s * n];
+        int32_t* rowNext = &next[(size_t)s * n];
+        priority_queue<pair<int, int>, vector<pair<int, int>>, greater<pair<int, int>>> pq;
+        rowDist[s] = 0;
+        rowNext[s] = s;
+        pq.push({0, s});
+        while (!pq.empty()) {
+            int d = pq.top().first, u = pq.top().second;
+            pq.pop();
+            if (d > rowDist[u]) continue;
+            for (const Neighbor& nb : g.neighbors(u)) {
+                if (d + nb.weight >= rowDist[nb.to]) continue;
+                rowDist[nb.to] = d + nb.weight;
+                rowNext[nb.to] = u == s ? nb.to : rowNext[u];
+                pq.push({rowDist[nb.to], nb.to});
+            }
+        }
+    }
+
+public:
+    static AllPairsTable build(const Graph& g, unsigned threads = 0) {
+        AllPairsTable table;
+        table.version = g.getVersion();
+        table.n = g.size();
+        table.dist.assign((size_t)table.n * table.n, INF);
+        table.next.assign((size_t)table.n * table.n, -1);
+        parallelFor(table.n, [&](size_t s, unsigned) { table.fillRow(g, s); }, threads);
+        return table;
+    }
+
+    uint64_t getVersion() const {
+        return version;
+    }
+
+    size_t memoryUsage() const {
+        return (dist.capacity() + next.capacity()) * sizeof(int32_t);
+    }
+
+    // Shortest walking route by following next hops; each hop is itself on a
+    // shortest path to the target, so the walk never leaves one
+    Route route(int start, int end) const {
+        Route route;
+        int32_t total = dist[(size_t)start * n + end];
+        if (total == INF) return route;
+        for (int v = start; v != end; v = next[(size_t)v * n + end]) route.path.push_back(v);
+        route.path.push_back(end);
+        route.cost = total;
+        route.distance = total;
+        return route;
+    }
+};
+
+// Route JSON as getDijkstraRoute gives it, read from the table
+json getTableRoute(const Graph& g, const AllPairsTable& table, int start, int end) {
+    if (table.getVersion() != g.getVersion()) throw logic_error("All-pairs table belongs to another graph version");
+    auto startTime = chrono::steady_clock::now();
+    Route route = table.route(start, end);
+    auto elapsed = chrono::steady_clock::now() - startTime;
+    json result = routeToJSON(g, "dijkstra", start, end, route);
+    result["table"] = true;
+    result["searchMicros"] = chrono::duration_cast<chrono::microseconds>(elapsed).count();
+    return result;
+}
@@ -0,0 +1,196 @@
+// Routing benchmark: times trace-free Dijkstra queries on a generated graph
+// under each node order, with the hardware cache misses they cause, then
+// compares traced and trace-free queries on a small graph. Point-to-point
+// searches include ALT and contraction hierarchy queries, and Dijkstra runs
+// once per frontier (priority queue) type. Build with "make bench".
+// Cache misses are read with perf_event_open on Linux; elsewhere, or where the
+// kernel denies access (perf_event_paranoid > 2, VMs without a PMU), they show
+// as n/a and only times are compared.
+#include "graph.hpp"
+#include "generator.hpp"
+#include "reorder.hpp"
+#include "dijkstra.hpp"
+#include "frontier.hpp"
+#include "bidirectional.hpp"
+#include "ch.hpp"
+#include "landmarks.hpp"
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <string>
+#include <vector>
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+// Last-level cache misses and references of this thread between start() and stop()
+class CacheCounters {
+private:
+    int misses = -1, references = -1;
+
+#ifdef __linux__
+    static int openCounter(uint64_t config) {
+        perf_event_attr attr{};
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.size = sizeof(attr);
+        attr.config = config;
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        return syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+    }
+
+    static long long read(int fd) {
+        long long value = 0;
+        return ::read(fd, &value, sizeof(value)) == sizeof(value) ? value : -1;
+    }
+#endif
+
+public:
+    CacheCounters() {
+#ifdef __linux__
+        misses = openCounter(PERF_COUNT_HW_CACHE_MISSES);
+        references = openCounter(PERF_COUNT_HW_CACHE_REFERENCES);
+#endif
+    }
+
+    ~CacheCounters() {
+#ifdef __linux__
+        if (misses >= 0) close(misses);
+        if (references >= 0) close(references);
+#endif
+    }
+
+    bool available() const {
+        return misses >= 0 && references >= 0;
+    }
+
+    void start() {
+#ifdef __linux__
+        if (!available()) return;
+        for (int fd : {misses, references}) {
+            ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+            ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+        }
+#endif
+    }
+
+    // "n misses (p% of references)", or "n/a"
+    string stop() {
+#ifdef __linux__
+        if (!available()) return "n/a";
+        for (int fd : {misses, references}) ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+        long long missCount = read(misses), referenceCount = read(references);
+        if (missCount < 0 || referenceCount <= 0) return "n/a";
+        return to_string(missCount) + " (" + to_string(100 * missCount / referenceCount) + "% of references)";
+#else
+        return "n/a";
+#endif
+    }
+};
+
+int main(int argc, char* argv[]) {
+    int nodeCount = argc > 1 ? stoi(argv[1]) : 200000;
+    int queryCount = argc > 2 ? stoi(argv[2]) : 200;
+    string kind = argc > 3 ? argv[3] : "geometric";
+
+    // Generated node ids follow placement order, which for geometric graphs is random
+    Graph base = generateGraph(kind, nodeCount, 42);
+    SplitMix64 rng(7);
+    vector<pair<int, int>> queries(queryCount);
+    for (auto& q : queries) q = {rng.below(nodeCount), rng.below(nodeCount)};
+
+    cout << kind << " graph, " << nodeCount << " nodes, " << queryCount << " queries" << endl;
+    long long reference = -1;
+    CacheCounters counters;
+    for (string order : {"none", "hilbert", "rcm"}) {
+        Graph g = base;
+        auto t0 = chrono::steady_clock::now();
+        reorderGraph(g, order);
+        auto t1 = chrono::steady_clock::now();
+
+        long long checksum = 0;
+        counters.start();
+        for (const auto& q : queries) {
+            checksum += shortestRoute(g, g.toInternal(q.first), g.toInternal(q.second)).cost;
+        }
+        string cacheMisses = counters.stop();
+        auto t2 = chrono::steady_clock::now();
+
+        if (reference == -1) reference = checksum;
+        cout << setw(8) << order
+             << "  reorder " << setw(7) << chrono::duration<double, milli>(t1 - t0).count() << " ms"
+             << "  queries " << setw(8) << chrono::duration<double, milli>(t2 - t1).count() << " ms"
+             << "  cache misses " << cacheMisses
+             << (checksum == reference ? "" : "  (distances differ!)") << endl;
+    }
+
+    // Point-to-point searches on the Hilbert-ordered graph
+    Graph ordered = base;
+    reorderGraph(ordered, "hilbert");
+    cout << "A* bound scale " << ordered.getBoundScale(0, false) << endl;
+    auto built = chrono::steady_clock::now();
+    ContractionHierarchy ch = buildContractionHierarchy(ordered);
+    cout << "Contraction hierarchy " << chrono::duration<double, milli>(chrono::steady_clock::now() - built).count()
+         << " ms, " << ch.shortcutCount() << " shortcuts" << endl;
+    built = chrono::steady_clock::now();
+    LandmarkTables landmarks = LandmarkTables::build(ordered, 8);
+    cout << "Landmark tables " << chrono::duration<double, milli>(chrono::steady_clock::now() - built).count()
+         << " ms, " << landmarks.getCount() << " landmarks" << endl;
+
+    // Same Dijkstra queries with each frontier; throughput is settled nodes per second
+    for (string frontier : {"binary-lazy", "indexed-2ary", "indexed-4ary", "radix"}) {
+        long long settled = 0, costs = 0;
+        auto t0 = chrono::steady_clock::now();
+        for (const auto& q : queries) {
+            int s = ordered.toInternal(q.first), t = ordered.toInternal(q.second);
+            Route route = frontier == "binary-lazy"    ? shortestRoute<BinaryFrontier>(ordered, s, t)
+                          : frontier == "indexed-2ary" ? shortestRoute<IndexedHeap<2>>(ordered, s, t)
+                          : frontier == "indexed-4ary" ? shortestRoute<IndexedHeap<4>>(ordered, s, t)
+                                                       : shortestRoute<RadixHeap>(ordered, s, t);
+            settled += route.settled;
+            costs += route.cost;
+        }
+        double seconds = chrono::duration<double>(chrono::steady_clock::now() - t0).count();
+        cout << setw(13) << frontier << "  queries " << setw(8) << seconds * 1000 << " ms  "
+             << setw(6) << settled / seconds / 1e6 << " M settled/s"
+             << (costs == reference ? "" : "  (distances differ!)") << endl;
+    }
+
+    for (string algorithm : {"dijkstra", "astar", "alt", "bidirectional", "ch"}) {
+        long long settled = 0, costs = 0;
+        auto t0 = chrono::steady_clock::now();
+        for (const auto& q : queries) {
+            int s = ordered.toInternal(q.first), t = ordered.toInternal(q.second);
+            Route route = algorithm == "ch"              ? ch.route(s, t)
+                          : algorithm == "bidirectional" ? bidirectionalRoute(ordered, s, t)
+                          : algorithm == "alt"           ? shortestRoute(ordered, s, t, -1, 0, true, &landmarks)
+                                                         : shortestRoute(ordered, s, t, -1, 0, algorithm == "astar");
+            settled += route.settled;
+            costs += route.cost;
+        }
+        auto t1 = chrono::steady_clock::now();
+        cout << setw(13) << algorithm << "  queries " << setw(8) << chrono::duration<double, milli>(t1 - t0).count()
+             << " ms (" << chrono::duration<double, micro>(t1 - t0).count() / queryCount << " us each)  settled " << settled / queryCount << " per query"
+             << (costs == reference ? "" : "  (distances differ!)") << endl;
+    }
+
+    // Traces copy every per-node array at each step, so keep this graph small
+    Graph small = generateGraph(kind, 500, 42);
+    auto t0 = chrono::steady_clock::now();
+    size_t traceBytes = 0;
+    for (int i = 0; i < 20; i++) traceBytes += getDijkstraPath(small, rng.below(500), rng.below(500)).dump().size();
+    auto t1 = chrono::steady_clock::now();
+    size_t routeBytes = 0;
+    for (int i = 0; i < 20; i++) routeBytes += getDijkstraRoute(small, rng.below(500), rng.below(500)).dump().size();
+    auto t2 = chrono::steady_clock::now();
+    cout << "500 nodes, 20 queries: traced " << chrono::duration<double, milli>(t1 - t0).count() << " ms ("
+         << traceBytes / 1024 << " KiB JSON), trace=none " << chrono::duration<double, milli>(t2 - t1).count()
+         << " ms (" << routeBytes / 1024 << " KiB JSON)" << endl;
+    return 0;
+}
@@ -0,0 +1,307 @@
+#pragma once
+#include "graph.hpp"
+#include "dijkstra.hpp"
+#include "workspace.hpp"
+#include "../lib/json.hpp"
+#include <queue>
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <chrono>
+
+using json = nlohmann::json;
+using namespace std;
+
+// Bidirectional Dijkstra: a forward search from `start` and a backward search
+// from `end` (edges are undirected, so both use the same rows) take turns, each
+// step settling the node with the smaller key of the two queues. Whenever an
+// edge reaches a node the other side has labelled, `best` (mu) is updated. The
+// search stops once the two queue minimums add up to at least `best`: no path
+// through an unsettled node can be shorter any more. Time-dependent costs are
+// not supported, since the backward search would need to know arrival times.
+
+typedef priority_queue<pair<int, int>, vector<pair<int, int>>, greater<pair<int, int>>> MinQueue;
+
+// Forward path start .. meet followed by the backward path meet .. end
+vector<int> joinPaths(const vector<int>& forwardPrevious, const vector<int>& backwardPrevious, int meet) {
+    vector<int> path;
+    for (int v = meet; v != -1; v = forwardPrevious[v]) path.push_back(v);
+    reverse(path.begin(), path.end());
+    for (int v = backwardPrevious[meet]; v != -1; v = backwardPrevious[v]) path.push_back(v);
+    return path;
+}
+
+// State of one search direction: labels and frontier from the calling thread's
+// workspace slot 0 (forward) or 1 (backward)
+struct SearchSide {
+    SearchWorkspace& labels;
+    IndexedHeap<4>& queue;
+
+    SearchSide(int n, int source, int slot)
+        : labels(searchWorkspace(n, slot)), queue(searchFrontier<IndexedHeap<4>>(n, slot)) {
+        labels[source].dist = 0;
+        queue.push(source, 0);
+    }
+};
+
+// Trace-free bidirectional search (the same result as shortestRoute without depart)
+Route bidirectionalRoute(const Graph& g, int start, int end, int routingProfile = 0) {
+    Route route;
+    if (!g.connected(start, end)) return route;
+
+    const int* profileCost = g.routingWeights(routingProfile);
+    SearchSide sides[2] = {SearchSide(g.size(), start, 0), SearchSide(g.size(), end, 1)};
+    int best = start == end ? 0 : INF;
+    int meet = start == end ? start : -1;
+
+    while (!sides[0].queue.empty() && !sides[1].queue.empty()) {
+        int forwardKey = sides[0].queue.topKey(), backwardKey = sides[1].queue.topKey();
+        if ((long long)forwardKey + backwardKey >= best) break;
+
+        int s = forwardKey <= backwardKey ? 0 : 1;
+        SearchSide& side = sides[s];
+        const SearchSide& other = sides[1 - s];
+        int u = side.queue.pop();
+        SearchWorkspace::Label& label = side.labels[u];
+        route.settled++;
+
+        int slot = g.rowOffset(u);
+        for (const Neighbor& nb : g.neighbors(u)) {
+            int cost = profileCost ? profileCost[slot] : nb.weight;
+            slot++;
+            if (cost == INF) continue;
+            int v = nb.to;
+            SearchWorkspace::Label& next = side.labels[v];
+            if (label.dist + cost < next.dist) {
+                next.dist = label.dist + cost;
+                next.previous = u;
+                next.length = label.length + nb.weight;
+                side.queue.push(v, next.dist);
+            }
+            if (other.labels.dist(v) != INF && next.dist + other.labels.dist(v) < best) {
+                best = next.dist + other.labels.dist(v);
+                meet = v;
+            }
+        }
+    }
+
+    if (meet < 0) return route;
+    for (int v = meet; v != -1; v = sides[0].labels[v].previous) route.path.push_back(v);
+    reverse(route.path.begin(), route.path.end());
+    for (int v = sides[1].labels[meet].previous; v != -1; v = sides[1].labels[v].previous) route.path.push_back(v);
+    route.cost = best;
+    route.distance = sides[0].labels[meet].length + sides[1].labels[meet].length;
+    return route;
+}
+
+// One step of the bidirectional trace: both frontiers at once
+struct BidirectionalStep {
+    int stepNum = 0;
+    int currentNode = -1;
+    string direction;  // "forward" or "backward"
+    string action;
+    string explanation;
+    vector<bool> visited[2];
+    vector<int> distances[2];
+    vector<int> previous[2];
+    vector<int> queue[2];
+    int best = INF;
+    int meet = -1;
+
+    json toJSON(const Graph& g) const {
+        // Forward state keeps the field names of DijkstraStep; backward state is prefixed
+        const char* prefix[2] = {"", "backward"};
+        json j;
+        j["step"] = stepNum;
+        j["node"] = g.toExternal(currentNode);
+        j["direction"] = direction;
+        j["action"] = action;
+        j["explanation"] = explanation;
+        for (int s = 0; s < 2; s++) {
+            string p = prefix[s];
+            vector<int> distCopy = distances[s];
+            for (auto& d : distCopy) {
+                if (d == INF) d = -1;
+            }
+            j[p.empty() ? "visited" : p + "Visited"] = toExternalOrder(g, visited[s]);
+            j[p.empty() ? "distances" : p + "Distances"] = toExternalOrder(g, distCopy);
+            j[p.empty() ? "previous" : p + "Previous"] = toExternalOrder(g, toExternalIds(g, previous[s]));
+            j[p.empty() ? "queue" : p + "Queue"] = toExternalIds(g, queue[s]);
+        }
+        j["best"] = best == INF ? -1 : best;
+        j["meeting"] = g.toExternal(meet);
+        return j;
+    }
+};
+
+class BidirectionalVisualizer {
+private:
+    const Graph& graph;
+    vector<BidirectionalStep> steps;
+
+    static vector<int> queueContents(MinQueue queue, const vector<bool>& visited) {
+        vector<int> nodes;
+        while (!queue.empty()) {
+            if (!visited[queue.top().second]) nodes.push_back(queue.top().second);
+            queue.pop();
+        }
+        return nodes;
+    }
+
+    void recordStep(int node, const string& direction, const string& action, const string& explanation,
+                    const vector<bool> visited[2], const vector<int> dist[2], const vector<int> previous[2],
+                    const MinQueue queues[2], int best, int meet) {
+        BidirectionalStep step;
+        step.stepNum = steps.size();
+        step.currentNode = node;
+        step.direction = direction;
+        step.action = action;
+        step.explanation = explanation;
+        for (int s = 0; s < 2; s++) {
+            step.visited[s] = visited[s];
+            step.distances[s] = dist[s];
+            step.previous[s] = previous[s];
+            step.queue[s] = queueContents(queues[s], visited[s]);
+        }
+        step.best = best;
+        step.meet = meet;
+        steps.push_back(step);
+    }
+
+public:
+    BidirectionalVisualizer(const Graph& g) : graph(g) {}
+
+    json findPath(int start, int end, int routingProfile = 0) {
+        auto startTime = chrono::steady_clock::now();
+        int n = graph.size();
+        const int* profileCost = graph.routingWeights(routingProfile);
+        const string names[2] = {"forward", "backward"};
+        vector<bool> visited[2] = {vector<bool>(n, false), vector<bool>(n, false)};
+        vector<int> dist[2] = {vector<int>(n, INF), vector<int>(n, INF)};
+        vector<int> previous[2] = {vector<int>(n, -1), vector<int>(n, -1)};
+        vector<int> length[2] = {vector<int>(n, 0), vector<int>(n, 0)};
+        MinQueue queues[2];
+        dist[0][start] = 0;
+        dist[1][end] = 0;
+        queues[0].push({0, start});
+        queues[1].push({0, end});
+        int best = start == end ? 0 : INF;
+        int meet = start == end ? start : -1;
+        int settled = 0;
+
+        recordStep(start, "forward", "Starting at " + graph.getNode(start).name + " and " + graph.getNode(end).name,
+                   "Search forward from " + graph.getNode(start).name + " and backward from " +
+                   graph.getNode(end).name + " at the same time. Each step settles the node with the "
+                   "smaller distance of the two queues.",
+                   visited, dist, previous, queues, best, meet);
+
+        bool reachable = graph.connected(start, end);
+        if (!reachable) {
+            recordStep(start, "forward", "No route to " + graph.getNode(end).name,
+                       graph.getNode(start).name + " and " + graph.getNode(end).name +
+                       " are in different connected components, so no path joins them.",
+                       visited, dist, previous, queues, best, meet);
+        }
+
+        while (reachable) {
+            for (int s = 0; s < 2; s++) {
+                while (!queues[s].empty() && visited[s][queues[s].top().second]) queues[s].pop();
+            }
+            if (queues[0].empty() || queues[1].empty()) break;
+
+            int forwardKey = queues[0].top().first, backwardKey = queues[1].top().first;
+            if ((long long)forwardKey + backwardKey >= best) {
+                recordStep(meet, "forward", "Frontiers met at " + graph.getNode(meet).name,
+                           "The smallest queued distances add up to " + to_string(forwardKey) + " + " +
+                           to_string(backwardKey) + " = " + to_string(forwardKey + backwardKey) +
+                           ", no less than the best path found (" + to_string(best) +
+                           " via " + graph.getNode(meet).name + "), so no shorter path remains.",
+                           visited, dist, previous, queues, best, meet);
+                break;
+            }
+
+            int s = forwardKey <= backwardKey ? 0 : 1;
+            int u = queues[s].top().second;
+            queues[s].pop();
+            visited[s][u] = true;
+            settled++;
+
+            recordStep(u, names[s], "Visiting " + graph.getNode(u).name + " (" + names[s] + ")",
+                       "The " + names[s] + " queue has the smaller minimum (" + to_string(dist[s][u]) +
+                       "), so the " + names[s] + " search settles " + graph.getNode(u).name + ".",
+                       visited, dist, previous, queues, best, meet);
+
+            int slot = graph.rowOffset(u);
+            for (const Neighbor& nb : graph.neighbors(u)) {
+                int cost = profileCost ? profileCost[slot] : nb.weight;
+                slot++;
+                if (cost == INF) continue;
+                int v = nb.to;
+                bool improved = dist[s][u] + cost < dist[s][v];
+                if (improved) {
+                    dist[s][v] = dist[s][u] + cost;
+                    previous[s][v] = u;
+                    length[s][v] = length[s][u] + nb.weight;
+                    queues[s].push({dist[s][v], v});
+                }
+                bool joined = dist[1 - s][v] != INF && dist[s][v] + dist[1 - s][v] < best;
+                if (joined) {
+                    best = dist[s][v] + dist[1 - s][v];
+                    meet = v;
+                }
+                if (improved || joined) {
+                    string explanation = improved ? "Found shorter " + names[s] + " path to " + graph.getNode(v).name +
+                                                        " via " + graph.getNode(u).name + ": " + to_string(dist[s][v]) + "."
+                                                  : "";
+                    if (joined) {
+                        explanation += string(improved ? " " : "") + graph.getNode(v).name +
+                                       " is labelled by both searches: best path so far " + to_string(best) + ".";
+                    }
+                    recordStep(u, names[s], "Relaxing edge to " + graph.getNode(v).name, explanation,
+                               visited, dist, previous, queues, best, meet);
+                }
+            }
+        }
+
+        vector<int> path;
+        if (meet >= 0) path = joinPaths(previous[0], previous[1], meet);
+
+        json result;
+        result["algorithm"] = "bidirectional";
+        result["profile"] = routingProfiles()[routingProfile].name;
+        result["start"] = graph.toExternal(start);
+        result["end"] = graph.toExternal(end);
+        result["startName"] = graph.getNode(start).name;
+        result["endName"] = graph.getNode(end).name;
+        result["distance"] = meet < 0 ? -1 : length[0][meet] + length[1][meet];
+        result["meeting"] = graph.toExternal(meet);
+        result["path"] = toExternalIds(graph, path);
+        result["steps"] = json::array();
+        for (const auto& step : steps) {
+            result["steps"].push_back(step.toJSON(graph));
+        }
+        result["settled"] = settled;
+        result["searchMicros"] = chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now() - startTime).count();
+        result["complexity"] = {
+            {"time", "O((V + E) log V)"},
+            {"space", "O(V)"},
+            {"description", "Two min-heaps, one per direction; stops when their minimums add up to the best path"}
+        };
+        return result;
+    }
+};
+
+json getBidirectionalPath(const Graph& g, int start, int end, int routingProfile = 0) {
+    BidirectionalVisualizer viz(g);
+    return viz.findPath(start, end, routingProfile);
+}
+
+// Path and distance only (?trace=none)
+json getBidirectionalRoute(const Graph& g, int start, int end, int routingProfile = 0) {
+    auto startTime = chrono::steady_clock::now();
+    Route route = bidirectionalRoute(g, start, end, routingProfile);
+    auto elapsed = chrono::steady_clock::now() - startTime;
+    json result = routeToJSON(g, "bidirectional", start, end, route, -1, routingProfile);
+    result["searchMicros"] = chrono::duration_cast<chrono::microseconds>(elapsed).count();
+    return result;
+}
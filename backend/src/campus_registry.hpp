@@ -0,0 +1,325 @@
+#pragma once
+#include "graph.hpp"
+#include "graph_store.hpp"
+#include "snapshot.hpp"
+#include "ch.hpp"
+#include "landmarks.hpp"
+#include "reorder.hpp"
+#include "workspace.hpp"
+#include "../lib/json.hpp"
+#include <atomic>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <fstream>
+#include <filesystem>
+#include <chrono>
+#include <iostream>
+#include <cctype>
+#include <stdexcept>
+
+using json = nlohmann::json;
+using namespace std;
+
+// Request counters for one campus
+struct CampusMetrics {
+    atomic<uint64_t> requests{0};
+    atomic<uint64_t> errors{0};
+    atomic<uint64_t> totalMicros{0};
+    atomic<uint64_t> loads{0};
+    atomic<uint64_t> evictions{0};
+
+    void record(uint64_t micros, bool failed) {
+        requests++;
+        totalMicros += micros;
+        if (failed) errors++;
+    }
+
+    json toJSON() const {
+        uint64_t count = requests.load();
+        json j;
+        j["requests"] = count;
+        j["errors"] = errors.load();
+        j["avgMicros"] = count ? totalMicros.load() / count : 0;
+        j["loads"] = loads.load();
+        j["evictions"] = evictions.load();
+        return j;
+    }
+};
+
+// One hosted campus. The graph is loaded on first use and may be evicted again;
+// metrics survive eviction.
+struct Campus {
+    string id;
+    CampusMetrics metrics;
+    shared_ptr<GraphStore> store;  // null while not loaded (guarded by the registry mutex)
+    size_t bytes = 0;
+    uint64_t loadedVersion = 0;  // graph version at load, to spot unsaved edge changes
+    bool pinned = false;  // built-in graphs have no snapshot to reload from
+    list<string>::iterator lruPosition;
+    mutex loadMutex;  // one loader per campus; other campuses keep serving
+};
+
+// A campus together with the graph store it had when acquired. The store stays
+// valid for the holder even if the campus is evicted meanwhile.
+struct CampusHandle {
+    shared_ptr<Campus> campus;
+    shared_ptr<GraphStore> store;
+};
+
+// Campus ID -> graph, loading snapshots from <dir>/<id>.cgs on demand and
+// evicting the least recently used graphs once the loaded total exceeds the budget.
+class CampusRegistry {
+private:
+    string snapshotDir;
+    size_t memoryBudget;
+    bool compressAdjacency;  // load snapshots with packed adjacency rows
+    string nodeOrder;  // renumber loaded graphs: "none", "hilbert" or "rcm"
+    int landmarkCount;  // ALT landmarks to place in campuses whose snapshot has none; 0 for none
+    int allPairsLimit;  // build all-pairs tables for campuses with at most this many nodes; 0 for none
+    mutex registryMutex;
+    map<string, shared_ptr<Campus>> campuses;
+    list<string> lru;  // loaded, evictable campuses, most recently used first
+    size_t loadedBytes = 0;
+
+    static bool isValidId(const string& id) {
+        if (id.empty() || id.size() > 64) return false;
+        for (char c : id) {
+            if (!isalnum(static_cast<unsigned char>(c)) && c != '-' && c != '_') return false;
+        }
+        return true;
+    }
+
+    string snapshotPath(const string& id) const {
+        return snapshotDir + "/" + id + ".cgs";
+    }
+
+    // A* bounds straight-line distance by edge cost; warn when coordinates and
+    // weights disagree enough that the bound has to be weakened noticeably
+    static void checkBoundScale(const string& id, const Graph& g) {
+        double scale = g.getBoundScale(0, false);
+        if (g.getEdges().empty() || scale >= 0.9) return;
+        cout << "Campus " << id << ": some edges are shorter than the straight line between their nodes; "
+             << "A* bounds are scaled by " << scale << endl;
+    }
+
+    // Contraction hierarchy stored with the snapshot, if it still matches the graph.
+    // newId maps snapshot order to the loaded graph's order (empty if unchanged).
+    static shared_ptr<const ContractionHierarchy> storedHierarchy(const SnapshotFile& file, const Graph& g,
+                                                                  const vector<int>& newId) {
+        if (!file.has("CHGR")) return nullptr;
+        ContractionHierarchy stored = ContractionHierarchy::fromSection(file.section("CHGR"));
+        if (stored.getVersion() != g.getVersion() || stored.size() != g.size()) return nullptr;
+        return make_shared<const ContractionHierarchy>(newId.empty() ? move(stored) : stored.renumbered(newId));
+    }
+
+    // Landmark tables stored with the snapshot, or computed now if the registry
+    // places landmarks and the snapshot has none for this version
+    shared_ptr<const LandmarkTables> campusLandmarks(const string& id, const SnapshotFile* file, const Graph& g,
+                                                     const vector<int>& newId) const {
+        if (file && file->has("LMRK")) {
+            LandmarkTables stored = LandmarkTables::fromSection(file->section("LMRK"));
+            if (stored.getVersion() == g.getVersion() && stored.nodeCount() == g.size()) {
+                return make_shared<const LandmarkTables>(newId.empty() ? move(stored) : stored.renumbered(newId));
+            }
+        }
+        if (landmarkCount == 0 || g.size() == 0) return nullptr;
+        auto startTime = chrono::steady_clock::now();
+        auto tables = make_shared<const LandmarkTables>(LandmarkTables::build(g, landmarkCount));
+        auto elapsed = chrono::duration_cast<chrono::milliseconds>(chrono::steady_clock::now() - startTime);
+        cout << "Campus " << id << ": " << tables->getCount() << " landmarks in " << elapsed.count() << " ms" << endl;
+        return tables;
+    }
+
+    // All-pairs table for a campus small enough to get one
+    shared_ptr<const AllPairsTable> campusAllPairs(const string& id, const Graph& g) const {
+        if (g.size() == 0 || g.size() > allPairsLimit) return nullptr;
+        auto startTime = chrono::steady_clock::now();
+        auto table = make_shared<const AllPairsTable>(AllPairsTable::build(g));
+        auto elapsed = chrono::duration_cast<chrono::milliseconds>(chrono::steady_clock::now() - startTime);
+        cout << "Campus " << id << ": all-pairs table (" << table->memoryUsage() / 1024 << " KiB) in "
+             << elapsed.count() << " ms" << endl;
+        return table;
+    }
+
+    // Save live edge changes next to the snapshot's other sections; they would be
+    // lost on reload otherwise. Written to a temporary file and renamed into place,
+    // so a failed write leaves the old snapshot intact.
+    void writeBack(const string& id, const GraphStore& store) {
+        shared_ptr<const Graph> graph = store.snapshot();
+        SnapshotFile file = SnapshotFile::load(snapshotPath(id));
+        file.putGraph(*graph);
+        shared_ptr<const ContractionHierarchy> ch = store.cachedHierarchy();
+        if (ch && ch->getVersion() == graph->getVersion()) file.setSection("CHGR", ch->toSection());
+        else file.removeSection("CHGR");
+        shared_ptr<const LandmarkTables> tables = store.cachedLandmarks();
+        if (tables && tables->getVersion() == graph->getVersion()) file.setSection("LMRK", tables->toSection());
+        else file.removeSection("LMRK");
+        string temporary = snapshotPath(id) + ".tmp";
+        file.save(temporary);
+        filesystem::rename(temporary, snapshotPath(id));
+    }
+
+    // Unload least recently used campuses until the loaded total fits the budget.
+    // Called without registryMutex: a victim's disk write holds only its own
+    // loadMutex, which keeps it from being reloaded before the write is done.
+    void evictOverBudget(const string& keep) {
+        while (true) {
+            shared_ptr<Campus> victim;
+            shared_ptr<GraphStore> store;
+            {
+                lock_guard<mutex> lock(registryMutex);
+                if (loadedBytes <= memoryBudget || lru.empty() || lru.back() == keep) return;
+                victim = campuses[lru.back()];
+            }
+
+            lock_guard<mutex> loading(victim->loadMutex);
+            uint64_t loadedVersion;
+            {
+                lock_guard<mutex> lock(registryMutex);
+                if (!victim->store) continue;  // evicted by another thread meanwhile
+                store = victim->store;
+                loadedVersion = victim->loadedVersion;
+            }
+
+            store->setReadOnly(true);
+            if (store->snapshot()->getVersion() > loadedVersion) {
+                try {
+                    writeBack(victim->id, *store);
+                } catch (const exception& e) {
+                    // Keep the campus loaded and writable rather than lose its changes
+                    store->setReadOnly(false);
+                    cout << "Cannot write back campus " << victim->id << ": " << e.what() << endl;
+                    return;
+                }
+            }
+
+            lock_guard<mutex> lock(registryMutex);
+            lru.erase(victim->lruPosition);
+            victim->store.reset();
+            loadedBytes -= victim->bytes;
+            victim->bytes = 0;
+            victim->metrics.evictions++;
+            releaseSearchMemory();
+            cout << "Evicted campus " << victim->id << endl;
+        }
+    }
+
+public:
+    CampusRegistry(const string& dir, size_t budgetBytes, bool compress = false, const string& order = "none",
+                   int landmarks = 0, int allPairsNodes = 0)
+        : snapshotDir(dir), memoryBudget(budgetBytes), compressAdjacency(compress), nodeOrder(order),
+          landmarkCount(landmarks), allPairsLimit(allPairsNodes) {}
+
+    // Register a graph that lives for the whole process (not counted against the budget)
+    void addBuiltin(const string& id, Graph g) {
+        lock_guard<mutex> lock(registryMutex);
+        auto campus = make_shared<Campus>();
+        campus->id = id;
+        campus->pinned = true;
+        campus->store = make_shared<GraphStore>(move(g));
+        campus->store->setLandmarks(campusLandmarks(id, nullptr, *campus->store->snapshot(), {}));
+        campus->store->setAllPairs(campusAllPairs(id, *campus->store->snapshot()));
+        campus->bytes = campus->store->memoryUsage();
+        campuses[id] = campus;
+        checkBoundScale(id, *campus->store->snapshot());
+    }
+
+    // Campus entry with its graph loaded; throws for unknown campuses
+    CampusHandle acquire(const string& id) {
+        if (!isValidId(id)) throw invalid_argument("Invalid campus id");
+
+        shared_ptr<Campus> campus;
+        shared_ptr<GraphStore> current;
+        {
+            lock_guard<mutex> lock(registryMutex);
+            auto it = campuses.find(id);
+            if (it == campuses.end()) {
+                if (!ifstream(snapshotPath(id))) throw invalid_argument("Unknown campus: " + id);
+                it = campuses.emplace(id, make_shared<Campus>()).first;
+                it->second->id = id;
+            }
+            campus = it->second;
+            if (campus->store && campus->pinned) return {campus, campus->store};
+            if (campus->store) {
+                // Background rebuilds replace routing structures, so sizes drift after edge changes
+                size_t bytes = campus->store->memoryUsage();
+                loadedBytes = loadedBytes - campus->bytes + bytes;
+                campus->bytes = bytes;
+                lru.splice(lru.begin(), lru, campus->lruPosition);
+                current = campus->store;
+            }
+        }
+        if (current) {
+            evictOverBudget(id);
+            return {campus, current};
+        }
+
+        shared_ptr<GraphStore> store;
+        {
+            lock_guard<mutex> loading(campus->loadMutex);
+            {
+                lock_guard<mutex> lock(registryMutex);
+                if (campus->store) return {campus, campus->store};  // loaded while we waited
+            }
+
+            // Parse outside the registry lock so other campuses are not blocked
+            SnapshotFile file = SnapshotFile::load(snapshotPath(id));
+            Graph loaded = file.getGraph();
+            vector<int> savedIds(loaded.size());
+            for (int i = 0; i < loaded.size(); i++) savedIds[i] = loaded.toExternal(i);
+            reorderGraph(loaded, nodeOrder);
+            if (compressAdjacency) loaded.setCompressedAdjacency(true);
+
+            // Precomputed data is stored in snapshot order
+            vector<int> newId(loaded.size());
+            bool moved = false;
+            for (int i = 0; i < loaded.size(); i++) {
+                newId[i] = loaded.toInternal(savedIds[i]);
+                moved = moved || newId[i] != i;
+            }
+            if (!moved) newId.clear();
+            shared_ptr<const ContractionHierarchy> ch = storedHierarchy(file, loaded, newId);
+            shared_ptr<const LandmarkTables> tables = campusLandmarks(id, &file, loaded, newId);
+            store = make_shared<GraphStore>(move(loaded));
+            store->setHierarchy(ch);
+            store->setLandmarks(tables);
+            store->setAllPairs(campusAllPairs(id, *store->snapshot()));
+            size_t bytes = store->memoryUsage();
+            cout << "Loaded campus " << id << " (" << bytes / 1024 << " KiB)" << endl;
+            checkBoundScale(id, *store->snapshot());
+
+            lock_guard<mutex> lock(registryMutex);
+            campus->store = store;
+            campus->bytes = bytes;
+            campus->loadedVersion = store->snapshot()->getVersion();
+            campus->metrics.loads++;
+            loadedBytes += bytes;
+            lru.push_front(id);
+            campus->lruPosition = lru.begin();
+        }
+        evictOverBudget(id);
+        return {campus, store};
+    }
+
+    json toJSON() {
+        lock_guard<mutex> lock(registryMutex);
+        json result;
+        result["memoryBudget"] = memoryBudget;
+        result["loadedBytes"] = loadedBytes;
+        result["campuses"] = json::array();
+        for (const auto& entry : campuses) {
+            const Campus& campus = *entry.second;
+            json c;
+            c["id"] = campus.id;
+            c["loaded"] = campus.store != nullptr;
+            c["pinned"] = campus.pinned;
+            c["bytes"] = campus.bytes;
+            if (campus.store) c["landmarks"] = campus.store->hasLandmarks();  // unknown until loaded
+            c["metrics"] = campus.metrics.toJSON();
+            result["campuses"].push_back(c);
+        }
+        return result;
+    }
+};
@@ -0,0 +1,454 @@
+#pragma once
+#include "graph.hpp"
+#include "snapshot.hpp"
+#include "parallel.hpp"
+#include "dijkstra.hpp"
+#include "workspace.hpp"
+#include "../lib/json.hpp"
+#include <queue>
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <algorithm>
+#include <chrono>
+#include <stdexcept>
+
+using json = nlohmann::json;
+using namespace std;
+
+// Contraction hierarchy over the walking weights (routing profile 0) of the open
+// edges. Nodes are contracted one at a time in order of importance; contracting u
+// adds a shortcut between two of its neighbours unless a "witness" path avoiding
+// u is at least as short. Every node keeps only its arcs to higher-ranked nodes,
+// and a query runs Dijkstra from both ends that only ever moves upwards: the two
+// searches meet at the highest node of the shortest path.
+
+// One upward arc; a shortcut stands for the two arcs through `middle`
+struct HierarchyArc {
+    int32_t to;
+    int32_t weight;
+    int32_t middle;  // -1 for an original edge
+};
+
+class ContractionHierarchy {
+private:
+    uint64_t version = 0;            // graph version the hierarchy was built for
+    vector<int> rank;                // contraction position of each node
+    vector<int> upOffset;            // arcs of u: upArcs[upOffset[u] .. upOffset[u+1])
+    vector<HierarchyArc> upArcs;
+
+    // The arc joining two nodes, stored with the lower-ranked one
+    const HierarchyArc& findArc(int a, int b) const {
+        int low = rank[a] < rank[b] ? a : b, high = low == a ? b : a;
+        for (int k = upOffset[low]; k < upOffset[low + 1]; k++) {
+            if (upArcs[k].to == high) return upArcs[k];
+        }
+        throw runtime_error("Contraction hierarchy is missing an arc");
+    }
+
+    // Append the original nodes of arc a -> b (without a); shortcuts are expanded
+    // with an explicit stack since they can nest deeply
+    void unpack(int a, int b, vector<int>& path) const {
+        vector<pair<int, int>> pending{{a, b}};
+        while (!pending.empty()) {
+            pair<int, int> arc = pending.back();
+            pending.pop_back();
+            int middle = findArc(arc.first, arc.second).middle;
+            if (middle < 0) {
+                path.push_back(arc.second);
+                continue;
+            }
+            pending.push_back({middle, arc.second});
+            pending.push_back({arc.first, middle});
+        }
+    }
+
+public:
+    ContractionHierarchy() {}
+
+    ContractionHierarchy(uint64_t graphVersion, vector<int> nodeRank, vector<int> offsets, vector<HierarchyArc> arcs)
+        : version(graphVersion), rank(move(nodeRank)), upOffset(move(offsets)), upArcs(move(arcs)) {
+        bool valid = upOffset.size() == rank.size() + 1 && upOffset.front() == 0 && upOffset.back() == (int)upArcs.size();
+        for (size_t i = 0; valid && i + 1 < upOffset.size(); i++) valid = upOffset[i] <= upOffset[i + 1];
+        for (const auto& arc : upArcs) valid = valid && arc.to >= 0 && arc.to < (int)rank.size();
+        if (!valid) throw runtime_error("Inconsistent contraction hierarchy");
+    }
+
+    uint64_t getVersion() const {
+        return version;
+    }
+
+    int size() const {
+        return rank.size();
+    }
+
+    size_t shortcutCount() const {
+        size_t count = 0;
+        for (const auto& arc : upArcs) count += arc.middle >= 0;
+        return count;
+    }
+
+    size_t memoryUsage() const {
+        return (rank.capacity() + upOffset.capacity()) * sizeof(int) + upArcs.capacity() * sizeof(HierarchyArc);
+    }
+
+    // Shortest walking route between two nodes; cost and distance are both meters.
+    // Labels live in the calling thread's workspace slots 0 (up from start) and 1 (up from end).
+    Route route(int start, int end) const {
+        Route result;
+        int n = rank.size();
+        SearchWorkspace* labels[2] = {&searchWorkspace(n, 0), &searchWorkspace(n, 1)};
+        IndexedHeap<4>* queue[2] = {&searchFrontier<IndexedHeap<4>>(n, 0), &searchFrontier<IndexedHeap<4>>(n, 1)};
+        (*labels[0])[start].dist = 0;
+        (*labels[1])[end].dist = 0;
+        queue[0]->push(start, 0);
+        queue[1]->push(end, 0);
+        int best = INF, meet = -1;
+        bool done[2] = {false, false};
+
+        // A direction is finished once its smallest key cannot improve on `best`
+        for (int s = 0; !done[0] || !done[1]; s = done[1 - s] ? s : 1 - s) {
+            if (queue[s]->empty() || queue[s]->topKey() >= best) {
+                done[s] = true;
+                continue;
+            }
+            SearchWorkspace& side = *labels[s];
+            int u = queue[s]->pop(), d = side.dist(u);
+            result.settled++;
+            int across = labels[1 - s]->dist(u);
+            if (across != INF && d + across < best) {
+                best = d + across;
+                meet = u;
+            }
+            // Stall-on-demand: a higher neighbour already offers a shorter way down to u,
+            // so u is not on a shortest up-path and need not be expanded
+            bool stalled = false;
+            for (int k = upOffset[u]; k < upOffset[u + 1] && !stalled; k++) {
+                stalled = side.dist(upArcs[k].to) != INF && side.dist(upArcs[k].to) + upArcs[k].weight < d;
+            }
+            if (stalled) continue;
+            for (int k = upOffset[u]; k < upOffset[u + 1]; k++) {
+                const HierarchyArc& arc = upArcs[k];
+                SearchWorkspace::Label& next = side[arc.to];
+                if (d + arc.weight < next.dist) {
+                    next.dist = d + arc.weight;
+                    next.previous = u;
+                    queue[s]->push(arc.to, next.dist);
+                }
+            }
+        }
+        if (meet < 0) return result;
+
+        // Hierarchy path start .. meet .. end, then every shortcut expanded
+        vector<int> corners;
+        for (int v = meet; v != -1; v = (*labels[0])[v].previous) corners.push_back(v);
+        reverse(corners.begin(), corners.end());
+        for (int v = (*labels[1])[meet].previous; v != -1; v = (*labels[1])[v].previous) corners.push_back(v);
+        result.path.push_back(start);
+        for (size_t i = 0; i + 1 < corners.size(); i++) unpack(corners[i], corners[i + 1], result.path);
+        result.cost = best;
+        result.distance = best;
+        return result;
+    }
+
+    // Every node the upward search from `source` settles without being stalled, with
+    // its distance; the search space many-to-many queries meet in. Uses workspace slot 0.
+    vector<pair<int, int>> upwardSearch(int source) const {
+        vector<pair<int, int>> space;
+        SearchWorkspace& labels = searchWorkspace(rank.size());
+        IndexedHeap<4>& queue = searchFrontier<IndexedHeap<4>>(rank.size());
+        labels[source].dist = 0;
+        queue.push(source, 0);
+        while (!queue.empty()) {
+            int u = queue.pop(), d = labels.dist(u);
+            bool stalled = false;
+            for (int k = upOffset[u]; k < upOffset[u + 1] && !stalled; k++) {
+                stalled = labels.dist(upArcs[k].to) != INF && labels.dist(upArcs[k].to) + upArcs[k].weight < d;
+            }
+            if (stalled) continue;
+            space.push_back({u, d});
+            for (int k = upOffset[u]; k < upOffset[u + 1]; k++) {
+                const HierarchyArc& arc = upArcs[k];
+                SearchWorkspace::Label& next = labels[arc.to];
+                if (d + arc.weight < next.dist) {
+                    next.dist = d + arc.weight;
+                    queue.push(arc.to, next.dist);
+                }
+            }
+        }
+        return space;
+    }
+
+    // Same hierarchy after Graph::renumber: node i is now newId[i]
+    ContractionHierarchy renumbered(const vector<int>& newId) const {
+        int n = rank.size();
+        vector<int> oldId(n);
+        for (int i = 0; i < n; i++) oldId[newId[i]] = i;
+
+        vector<int> newRank(n), offsets(n + 1, 0);
+        vector<HierarchyArc> arcs;
+        arcs.reserve(upArcs.size());
+        for (int v = 0; v < n; v++) {
+            int u = oldId[v];
+            newRank[v] = rank[u];
+            for (int k = upOffset[u]; k < upOffset[u + 1]; k++) {
+                const HierarchyArc& arc = upArcs[k];
+                arcs.push_back({newId[arc.to], arc.weight, arc.middle < 0 ? -1 : newId[arc.middle]});
+            }
+            offsets[v + 1] = arcs.size();
+        }
+        return ContractionHierarchy(version, move(newRank), move(offsets), move(arcs));
+    }
+
+    // Snapshot section "CHGR"
+    string toSection() const {
+        ByteWriter out;
+        out.put<uint64_t>(version);
+        out.putArray(rank);
+        out.putArray(upOffset);
+        out.putArray(upArcs);
+        return out.str();
+    }
+
+    static ContractionHierarchy fromSection(const string& bytes) {
+        ByteReader in(bytes);
+        uint64_t graphVersion = in.get<uint64_t>();
+        vector<int> nodeRank = in.getArray<int>();
+        vector<int> offsets = in.getArray<int>();
+        vector<HierarchyArc> arcs = in.getArray<HierarchyArc>();
+        return ContractionHierarchy(graphVersion, move(nodeRank), move(offsets), move(arcs));
+    }
+};
+
+// Preprocessing. Each round contracts an independent set of nodes in parallel:
+// nodes whose priority (shortcuts they would add minus arcs they remove, plus
+// already contracted neighbours) is lower than that of all their neighbours.
+// Witness searches skip the whole round's set, so simultaneous contractions
+// cannot rely on each other; they give up after a fixed number of nodes, which at
+// worst adds a superfluous shortcut.
+class HierarchyBuilder {
+private:
+    struct Shortcut {
+        int from, to, weight;
+    };
+
+    // Witness search scratch space of one worker
+    struct Workspace {
+        vector<int> dist;
+        vector<int> touched;
+        vector<char> target;  // neighbours still waiting for their witness distance
+        priority_queue<pair<int, int>, vector<pair<int, int>>, greater<pair<int, int>>> queue;
+    };
+
+    // Witness searches settle at most this many nodes; estimating priorities
+    // happens far more often than contracting, so it searches less
+    static const int contractLimit = 500;
+    static const int estimateLimit = 25;
+
+    const Graph& g;
+    int n;
+    unsigned threads;
+    vector<vector<HierarchyArc>> arcs;  // arcs to uncontracted nodes; frozen once the node is contracted
+    vector<char> contracted, inRound;
+    vector<int> priority, deletedNeighbors;
+    vector<Workspace> workspaces;
+
+    static uint32_t mix(uint32_t x) {
+        x ^= x >> 16;
+        x *= 0x7feb352d;
+        x ^= x >> 15;
+        x *= 0x846ca68b;
+        return x ^ (x >> 16);
+    }
+
+    // Ties are broken by a hash so equal priorities do not contract in id order
+    bool before(int a, int b) const {
+        if (priority[a] != priority[b]) return priority[a] < priority[b];
+        return mix(a) < mix(b);
+    }
+
+    // Keep the shorter of two arcs between the same pair
+    static void addArc(vector<HierarchyArc>& row, int to, int weight, int middle) {
+        for (auto& arc : row) {
+            if (arc.to == to) {
+                if (weight < arc.weight) arc = {to, weight, middle};
+                return;
+            }
+        }
+        row.push_back({to, weight, middle});
+    }
+
+    static void removeArc(vector<HierarchyArc>& row, int to) {
+        for (size_t i = 0; i < row.size(); i++) {
+            if (row[i].to == to) {
+                row[i] = row.back();
+                row.pop_back();
+                return;
+            }
+        }
+    }
+
+    // Distances from source avoiding `skip` and this round's nodes; stops once
+    // `targets` marked nodes are settled or distances exceed `limit`
+    void witnessSearch(int source, int skip, int limit, int targets, int settleLimit, Workspace& ws) const {
+        for (int v : ws.touched) ws.dist[v] = INF;
+        ws.touched.clear();
+        while (!ws.queue.empty()) ws.queue.pop();
+
+        ws.dist[source] = 0;
+        ws.touched.push_back(source);
+        ws.queue.push({0, source});
+        int settled = 0;
+        while (!ws.queue.empty() && targets > 0) {
+            int d = ws.queue.top().first, u = ws.queue.top().second;
+            ws.queue.pop();
+            if (d > ws.dist[u]) continue;
+            if (d > limit || ++settled > settleLimit) break;
+            targets -= ws.target[u];
+            for (const auto& arc : arcs[u]) {
+                int v = arc.to;
+                if (v == skip || inRound[v]) continue;
+                if (d + arc.weight < ws.dist[v]) {
+                    if (ws.dist[v] == INF) ws.touched.push_back(v);
+                    ws.dist[v] = d + arc.weight;
+                    ws.queue.push({ws.dist[v], v});
+                }
+            }
+        }
+    }
+
+    // Shortcuts that contracting u needs; only counted when out is null.
+    // Neighbour i searches for witnesses to the neighbours after it.
+    int shortcutsFor(int u, Workspace& ws, vector<Shortcut>* out) const {
+        const vector<HierarchyArc>& row = arcs[u];
+        int count = 0;
+        for (size_t i = 0; i + 1 < row.size(); i++) {
+            int longest = 0;
+            for (size_t j = i + 1; j < row.size(); j++) {
+                longest = max(longest, row[j].weight);
+                ws.target[row[j].to] = 1;
+            }
+            witnessSearch(row[i].to, u, row[i].weight + longest, row.size() - i - 1, out ? contractLimit : estimateLimit, ws);
+            for (size_t j = i + 1; j < row.size(); j++) {
+                ws.target[row[j].to] = 0;
+                int via = row[i].weight + row[j].weight;
+                if (ws.dist[row[j].to] <= via) continue;
+                count++;
+                if (out) out->push_back({row[i].to, row[j].to, via});
+            }
+        }
+        return count;
+    }
+
+    void updatePriority(int u, Workspace& ws) {
+        priority[u] = 2 * shortcutsFor(u, ws, nullptr) - (int)arcs[u].size() + deletedNeighbors[u];
+    }
+
+public:
+    HierarchyBuilder(const Graph& graph, unsigned threadCount = 0)
+        : g(graph), n(graph.size()), threads(parallelThreads(threadCount)) {}
+
+    ContractionHierarchy build() {
+        arcs.assign(n, {});
+        for (int u = 0; u < n; u++) {
+            for (const Neighbor& nb : g.neighbors(u)) {
+                if (nb.to != u) addArc(arcs[u], nb.to, nb.weight, -1);
+            }
+        }
+        contracted.assign(n, 0);
+        inRound.assign(n, 0);
+        priority.assign(n, 0);
+        deletedNeighbors.assign(n, 0);
+        workspaces.assign(threads, Workspace());
+        for (auto& ws : workspaces) {
+            ws.dist.assign(n, INF);
+            ws.target.assign(n, 0);
+        }
+
+        vector<int> remaining(n);
+        for (int i = 0; i < n; i++) remaining[i] = i;
+        parallelFor(n, [&](size_t i, unsigned w) { updatePriority(i, workspaces[w]); }, threads);
+
+        vector<int> rank(n, -1);
+        int nextRank = 0;
+        vector<char> dirty(n, 0);
+        while (!remaining.empty()) {
+            // Nodes ahead of all their uncontracted neighbours
+            vector<char> pick(remaining.size(), 0);
+            parallelFor(remaining.size(), [&](size_t i, unsigned) {
+                int u = remaining[i];
+                bool minimal = true;
+                for (const auto& arc : arcs[u]) minimal = minimal && before(u, arc.to);
+                pick[i] = minimal;
+            }, threads);
+            vector<int> selected;
+            for (size_t i = 0; i < remaining.size(); i++) {
+                if (pick[i]) selected.push_back(remaining[i]);
+            }
+            for (int u : selected) inRound[u] = 1;
+
+            vector<vector<Shortcut>> found(selected.size());
+            parallelFor(selected.size(), [&](size_t i, unsigned w) { shortcutsFor(selected[i], workspaces[w], &found[i]); },
+                        threads);
+
+            vector<int> touched;
+            for (size_t i = 0; i < selected.size(); i++) {
+                int u = selected[i];
+                rank[u] = nextRank++;
+                contracted[u] = 1;
+                inRound[u] = 0;
+                for (const auto& s : found[i]) {
+                    addArc(arcs[s.from], s.to, s.weight, u);
+                    addArc(arcs[s.to], s.from, s.weight, u);
+                }
+                for (const auto& arc : arcs[u]) {
+                    removeArc(arcs[arc.to], u);
+                    deletedNeighbors[arc.to]++;
+                    if (!dirty[arc.to]) {
+                        dirty[arc.to] = 1;
+                        touched.push_back(arc.to);
+                    }
+                }
+            }
+
+            vector<int> next;
+            next.reserve(remaining.size() - selected.size());
+            for (int u : remaining) {
+                if (!contracted[u]) next.push_back(u);
+            }
+            remaining.swap(next);
+
+            touched.erase(remove_if(touched.begin(), touched.end(), [&](int v) { return contracted[v] != 0; }), touched.end());
+            parallelFor(touched.size(), [&](size_t i, unsigned w) { updatePriority(touched[i], workspaces[w]); }, threads);
+            for (int v : touched) dirty[v] = 0;
+        }
+
+        // What is left in a node's arc list are exactly its arcs to higher-ranked nodes
+        vector<int> offsets(n + 1, 0);
+        vector<HierarchyArc> upArcs;
+        for (int u = 0; u < n; u++) {
+            upArcs.insert(upArcs.end(), arcs[u].begin(), arcs[u].end());
+            offsets[u + 1] = upArcs.size();
+            vector<HierarchyArc>().swap(arcs[u]);
+        }
+        return ContractionHierarchy(g.getVersion(), move(rank), move(offsets), move(upArcs));
+    }
+};
+
+ContractionHierarchy buildContractionHierarchy(const Graph& g, unsigned threads = 0) {
+    HierarchyBuilder builder(g, threads);
+    return builder.build();
+}
+
+// Path and distance by hierarchy query (always trace-free)
+json getHierarchyRoute(const Graph& g, const ContractionHierarchy& ch, int start, int end) {
+    if (ch.getVersion() != g.getVersion() || ch.size() != g.size()) {
+        throw logic_error("Contraction hierarchy belongs to another graph version");
+    }
+    auto startTime = chrono::steady_clock::now();
+    Route route = g.connected(start, end) ? ch.route(start, end) : Route();
+    auto elapsed = chrono::steady_clock::now() - startTime;
+    json result = routeToJSON(g, "ch", start, end, route);
+    result["searchMicros"] = chrono::duration_cast<chrono::microseconds>(elapsed).count();
+    return result;
+}
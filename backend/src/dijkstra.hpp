@@ -1,13 +1,117 @@
 #pragma once
 #include "graph.hpp"
+#include "heuristic.hpp"
+#include "frontier.hpp"
+#include "workspace.hpp"
 #include "../lib/json.hpp"
-#include <queue>
 #include <vector>
+#include <string>
 #include <algorithm>
+#include <chrono>
 
 using json = nlohmann::json;
 using namespace std;
 
+// Reorder a per-node array from internal to external (API) node ids
+template <typename T>
+vector<T> toExternalOrder(const Graph& g, const vector<T>& values) {
+    if (!g.isRenumbered()) return values;
+    vector<T> reordered(values.size());
+    for (size_t i = 0; i < values.size(); i++) {
+        reordered[g.toExternal(i)] = values[i];
+    }
+    return reordered;
+}
+
+// Map a list of internal node ids to external ones
+vector<int> toExternalIds(const Graph& g, vector<int> ids) {
+    for (auto& id : ids) id = g.toExternal(id);
+    return ids;
+}
+
+// A route found without recording a trace; node ids are internal
+struct Route {
+    vector<int> path;   // start .. end, empty if there is no route
+    int cost = -1;      // what the search minimised: meters, profile cost or seconds; -1 if no route
+    int distance = -1;  // meters along the path
+    int settled = 0;    // nodes taken off the queue
+};
+
+// Shortest route (fastest with depart >= 0) with the same semantics as
+// DijkstraVisualizer::findPath, but keeping only dist/previous/length per node
+// and no steps, in the calling thread's workspace: it costs what it touches, and
+// it stops as soon as `end` is settled.
+// astar orders the queue by distance plus the Euclidean bound to `end`, raised
+// to the landmark bound when landmark tables are given (ALT). The frontier is an
+// indexed 4-ary heap unless another one from frontier.hpp is named.
+template <typename Frontier = IndexedHeap<4>>
+Route shortestRoute(const Graph& g, int start, int end, int depart = -1, int routingProfile = 0, bool astar = false,
+                    const LandmarkTables* landmarks = nullptr) {
+    Route route;
+    if (!g.connected(start, end)) return route;
+
+    int n = g.size();
+    bool timed = depart >= 0;
+    const int* profileCost = g.routingWeights(routingProfile);
+    RemainingBound bound = !astar    ? RemainingBound()
+                           : landmarks ? RemainingBound::landmarks(g, *landmarks, end, routingProfile, timed)
+                                       : RemainingBound::euclidean(g, end, routingProfile, timed);
+    SearchWorkspace& labels = searchWorkspace(n);
+    Frontier& frontier = searchFrontier<Frontier>(n);
+    labels[start].dist = 0;
+    frontier.push(start, bound(start));
+
+    while (!frontier.empty()) {
+        int u = frontier.pop();
+        SearchWorkspace::Label& label = labels[u];
+        if (label.settled) continue;  // stale entry of a lazy frontier
+        label.settled = 1;
+        route.settled++;
+        int d = label.dist, walked = label.length;
+        if (u == end) break;
+
+        int slot = g.rowOffset(u);
+        for (const Neighbor& nb : g.neighbors(u)) {
+            int cost = profileCost ? profileCost[slot] : nb.weight;
+            int weight = (timed && cost != INF) ? g.travelSeconds(slot, cost, (long long)depart + d) : cost;
+            slot++;
+            if (cost == INF) continue;
+            SearchWorkspace::Label& next = labels[nb.to];
+            if (d + weight >= next.dist) continue;
+            next.dist = d + weight;
+            next.previous = u;
+            next.length = walked + nb.weight;
+            frontier.push(nb.to, next.dist + bound(nb.to));
+        }
+    }
+
+    if (labels.dist(end) == INF) return route;
+    for (int v = end; v != -1; v = labels[v].previous) route.path.push_back(v);
+    reverse(route.path.begin(), route.path.end());
+    route.cost = labels[end].dist;
+    route.distance = labels[end].length;
+    return route;
+}
+
+// Route JSON without steps: the fields of getDijkstraPath except the trace
+json routeToJSON(const Graph& g, const string& algorithm, int start, int end, const Route& route,
+                 int depart = -1, int routingProfile = 0) {
+    json result;
+    result["algorithm"] = algorithm;
+    result["profile"] = routingProfiles()[routingProfile].name;
+    result["start"] = g.toExternal(start);
+    result["end"] = g.toExternal(end);
+    result["distance"] = route.distance;
+    result["settled"] = route.settled;
+    if (depart >= 0) {
+        result["depart"] = formatTimeOfDay(depart);
+        result["travelSeconds"] = route.cost;
+        if (route.cost >= 0) result["arrival"] = formatTimeOfDay((long long)depart + route.cost);
+    }
+    result["path"] = toExternalIds(g, route.path);
+    return result;
+}
+
 // Step structure for visualization
 struct DijkstraStep {
     int stepNum;
@@ -24,19 +128,19 @@ struct DijkstraStep {
     json toJSON(const Graph& g) const {
         json j;
         j["step"] = stepNum;
-        j["node"] = currentNode;
+        j["node"] = g.toExternal(currentNode);
         j["action"] = action;
         j["explanation"] = explanation;
-        j["visited"] = visited;
+        j["visited"] = toExternalOrder(g, visited);
         
         // Convert distances (INF to -1 for JSON)
         vector<int> distCopy = distances;
         for (auto& d : distCopy) {
             if (d == INF) d = -1;
         }
-        j["distances"] = distCopy;
-        j["previous"] = previous;
-        j["queue"] = currentQueue;
+        j["distances"] = toExternalOrder(g, distCopy);
+        j["previous"] = toExternalOrder(g, toExternalIds(g, previous));
+        j["queue"] = toExternalIds(g, currentQueue);
         
         return j;
     }
@@ -63,80 +167,114 @@ private:
         steps.push_back(step);
     }
     
+    // Queued nodes in the order they would be taken
+    static vector<int> queueOrder(const IndexedHeap<4>& frontier) {
+        vector<pair<int, int>> items = frontier.items();
+        sort(items.begin(), items.end());
+        vector<int> nodes;
+        for (const auto& item : items) nodes.push_back(item.second);
+        return nodes;
+    }
     
 public:
     DijkstraVisualizer(const Graph& g) : graph(g), stepNum(0) {}
     
-    json findPath(int start, int end) {
+    // depart < 0: static search over edge weights (meters).
+    // depart >= 0: time-dependent search leaving at `depart` seconds after midnight;
+    // distances are then seconds since departure and each edge is timed at the
+    // moment it is entered.
+    // routingProfile (index into routingProfiles()) replaces the weights with that
+    // profile's precompiled edge costs.
+    // astar runs A*: the queue is ordered by distance plus a straight-line lower
+    // bound to `end`, so the search settles fewer nodes away from the target.
+    // With landmark tables the bound also uses landmark distances (ALT).
+    json findPath(int start, int end, int depart = -1, int routingProfile = 0, bool astar = false,
+                  const LandmarkTables* landmarks = nullptr) {
+        auto startTime = chrono::steady_clock::now();
         int n = graph.size();
+        bool timed = depart >= 0;
+        const int* profileCost = graph.routingWeights(routingProfile);
+        RemainingBound bound = !astar    ? RemainingBound()
+                               : landmarks ? RemainingBound::landmarks(graph, *landmarks, end, routingProfile, timed)
+                                           : RemainingBound::euclidean(graph, end, routingProfile, timed);
+        string estimate = landmarks ? "landmark" : "straight-line";
+        int settled = 0;
+        string unit = timed ? "s" : "m";
         vector<int> dist(n, INF);
         vector<bool> visited(n, false);
         vector<int> previous(n, -1);
+        vector<int> length(n, 0);  // meters walked along the current best path
         
-        // Priority queue: pair<distance, node>
-        priority_queue<pair<int, int>, vector<pair<int, int>>, greater<pair<int, int>>> pq;
+        // Frontier keyed by distance (plus estimate); each node is queued at most once
+        IndexedHeap<4> frontier(n);
         
         dist[start] = 0;
-        pq.push({0, start});
+        frontier.push(start, bound(start));
         
         // Initial step
         vector<int> queueViz = {start};
         recordStep(start, 
                   "Starting at " + graph.getNode(start).name,
                   "Initialize distance to start node as 0, all others as infinity. "
-                  "Add start node to priority queue.",
+                  "Add start node to priority queue." +
+                  string(astar ? " The queue is ordered by distance plus the " + estimate + " estimate to " +
+                                     graph.getNode(end).name + "." : ""),
                   visited, dist, previous, queueViz);
         
-
+        // Component labels answer unreachable pairs without exploring the start's component
+        bool reachable = graph.connected(start, end);
+        if (!reachable) {
+            recordStep(start,
+                      "No route to " + graph.getNode(end).name,
+                      graph.getNode(start).name + " and " + graph.getNode(end).name +
+                      " are in different connected components, so no path joins them.",
+                      visited, dist, previous, queueViz);
+        }
         
-        while (!pq.empty()) {
-            int u = pq.top().second;
-            int currentDist = pq.top().first;
-            pq.pop();
-            
-            if (visited[u]) continue;
+        while (reachable && !frontier.empty()) {
+            int u = frontier.pop();
             
             visited[u] = true;
+            settled++;
             
             // Build current queue visualization
-            priority_queue<pair<int, int>, vector<pair<int, int>>, greater<pair<int, int>>> tempPQ = pq;
-            queueViz.clear();
-            while (!tempPQ.empty()) {
-                queueViz.push_back(tempPQ.top().second);
-                tempPQ.pop();
-            }
+            queueViz = queueOrder(frontier);
             
             // Record visit step
             string action = "Visiting " + graph.getNode(u).name;
-            string explanation = "Selected " + graph.getNode(u).name + 
-                               " as it has the minimum distance (" + to_string(dist[u]) + 
-                               "m) among unvisited nodes. Mark it as visited.";
+            string explanation = astar
+                ? "Selected " + graph.getNode(u).name + " as it has the minimum distance plus estimate (" +
+                      to_string(dist[u]) + unit + " + " + to_string(bound(u)) + unit +
+                      ") among unvisited nodes. Mark it as visited."
+                : "Selected " + graph.getNode(u).name + 
+                      " as it has the minimum distance (" + to_string(dist[u]) + 
+                      unit + ") among unvisited nodes. Mark it as visited.";
             recordStep(u, action, explanation, visited, dist, previous, queueViz);
             
             // Relax edges
-            for (int v = 0; v < n; v++) {
-                int weight = graph.getWeight(u, v);
-                if (weight > 0 && !visited[v]) {
+            int slot = graph.rowOffset(u);
+            for (const Neighbor& nb : graph.neighbors(u)) {
+                int v = nb.to;
+                int cost = profileCost ? profileCost[slot] : nb.weight;
+                int weight = timed ? graph.travelSeconds(slot, cost, (long long)depart + dist[u]) : cost;
+                slot++;
+                if (cost != INF && !visited[v]) {
                     int newDist = dist[u] + weight;
                     
                     if (newDist < dist[v]) {
                         dist[v] = newDist;
                         previous[v] = u;
-                        pq.push({newDist, v});
+                        length[v] = length[u] + nb.weight;
+                        frontier.push(v, newDist + bound(v));
                         
                         // Record relaxation step
                         action = "Relaxing edge to " + graph.getNode(v).name;
                         explanation = "Found shorter path to " + graph.getNode(v).name + 
                                     " via " + graph.getNode(u).name + ". " +
-                                    "Updated distance: " + to_string(dist[v]) + "m " +
-                                    "(previous: " + to_string(currentDist + weight) + "m).";
+                                    "Updated distance: " + to_string(dist[v]) + unit + " " +
+                                    "(previous: " + to_string(dist[u] + weight) + unit + ").";
                         
-                        tempPQ = pq;
-                        queueViz.clear();
-                        while (!tempPQ.empty()) {
-                            queueViz.push_back(tempPQ.top().second);
-                            tempPQ.pop();
-                        }
+                        queueViz = queueOrder(frontier);
                         
                         recordStep(u, action, explanation, visited, dist, previous, queueViz);
                     }
@@ -145,9 +283,13 @@ public:
             
             // If we reached the destination, we can stop
             if (u == end) {
-                recordStep(end,
-                          "Reached destination: " + graph.getNode(end).name,
-                          "Found shortest path! Total distance: " + to_string(dist[end]) + "m",
+                string total = timed ? "Found fastest path! Travel time: " + to_string(dist[end]) + "s, arriving at " +
+                                           formatTimeOfDay((long long)depart + dist[end])
+                                     : "Found shortest path! Total distance: " + to_string(length[end]) + "m";
+                if (profileCost && !timed) {
+                    total += " (" + routingProfiles()[routingProfile].name + " cost " + to_string(dist[end]) + ")";
+                }
+                recordStep(end, "Reached destination: " + graph.getNode(end).name, total,
                           visited, dist, previous, queueViz);
                 break;
             }
@@ -164,32 +306,58 @@ public:
         
         // Build JSON response
         json result;
-        result["algorithm"] = "dijkstra";
-        result["start"] = start;
-        result["end"] = end;
+        result["algorithm"] = !astar ? "dijkstra" : landmarks ? "alt" : "astar";
+        result["profile"] = routingProfiles()[routingProfile].name;
+        result["start"] = graph.toExternal(start);
+        result["end"] = graph.toExternal(end);
         result["startName"] = graph.getNode(start).name;
         result["endName"] = graph.getNode(end).name;
-        result["distance"] = (dist[end] == INF) ? -1 : dist[end];
-        result["path"] = path;
+        result["distance"] = (dist[end] == INF) ? -1 : length[end];
+        if (timed) {
+            result["depart"] = formatTimeOfDay(depart);
+            result["travelSeconds"] = (dist[end] == INF) ? -1 : dist[end];
+            if (dist[end] != INF) result["arrival"] = formatTimeOfDay((long long)depart + dist[end]);
+        }
+        result["path"] = toExternalIds(graph, path);
         result["steps"] = json::array();
         
         for (const auto& step : steps) {
             result["steps"].push_back(step.toJSON(graph));
         }
         
+        result["settled"] = settled;
+        result["searchMicros"] = chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now() - startTime).count();
+        
         // Add complexity info
         result["complexity"] = {
             {"time", "O((V + E) log V)"},
             {"space", "O(V)"},
-            {"description", "Using min-heap priority queue"}
+            {"description", astar ? "Indexed 4-ary min-heap ordered by distance + " + estimate + " bound"
+                                  : "Using an indexed 4-ary min-heap with decrease-key"}
         };
         
         return result;
     }
 };
 
-// Main API function
-json getDijkstraPath(const Graph& g, int start, int end) {
+// Traces copy every per-node array at each step, so they grow with the square of
+// the graph; /api/dijkstra refuses trace=full on larger graphs
+const int maxTraceNodes = 2000;
+
+// Main API function; depart (seconds after midnight) selects time-dependent routing
+json getDijkstraPath(const Graph& g, int start, int end, int depart = -1, int routingProfile = 0, bool astar = false,
+                     const LandmarkTables* landmarks = nullptr) {
     DijkstraVisualizer viz(g);
-    return viz.findPath(start, end);
-}
\ No newline at end of file
+    return viz.findPath(start, end, depart, routingProfile, astar, landmarks);
+}
+
+// Path and distance only (?trace=none)
+json getDijkstraRoute(const Graph& g, int start, int end, int depart = -1, int routingProfile = 0, bool astar = false,
+                      const LandmarkTables* landmarks = nullptr) {
+    auto startTime = chrono::steady_clock::now();
+    Route route = shortestRoute(g, start, end, depart, routingProfile, astar, landmarks);
+    auto elapsed = chrono::steady_clock::now() - startTime;
+    json result = routeToJSON(g, !astar ? "dijkstra" : landmarks ? "alt" : "astar", start, end, route, depart, routingProfile);
+    result["searchMicros"] = chrono::duration_cast<chrono::microseconds>(elapsed).count();
+    return result;
+}
@@ -0,0 +1,36 @@
+#pragma once
+#include <vector>
+#include <utility>
+
+using namespace std;
+
+// Union-find with union by size and path halving; near-constant time per operation
+class DisjointSet {
+private:
+    vector<int> parent;
+    vector<int> setSize;
+
+public:
+    DisjointSet(int n) : parent(n), setSize(n, 1) {
+        for (int i = 0; i < n; i++) parent[i] = i;
+    }
+
+    int find(int x) {
+        while (parent[x] != x) {
+            parent[x] = parent[parent[x]];
+            x = parent[x];
+        }
+        return x;
+    }
+
+    // Merge the sets of a and b; false if they were already together
+    bool unite(int a, int b) {
+        a = find(a);
+        b = find(b);
+        if (a == b) return false;
+        if (setSize[a] < setSize[b]) swap(a, b);
+        parent[b] = a;
+        setSize[a] += setSize[b];
+        return true;
+    }
+};
@@ -0,0 +1,224 @@
+#pragma once
+#include <queue>
+#include <vector>
+#include <cstdint>
+#include <utility>
+#include <algorithm>
+#include <functional>
+
+using namespace std;
+
+// Search frontiers for the Dijkstra family: queues of node ids ordered by an int
+// key. Each offers push(node, key) to insert a node or lower its key, pop() to
+// take the node of smallest key, empty(), clear(), reserve(nodeCount) and
+// release() to free all memory. Lazy frontiers keep one entry per push, so pop()
+// may return a node that was already taken; searches skip those the way they
+// always have.
+
+// std::priority_queue with lazy deletion, the original frontier
+class BinaryFrontier {
+private:
+    priority_queue<pair<int, int>, vector<pair<int, int>>, greater<pair<int, int>>> pq;
+
+public:
+    explicit BinaryFrontier(int = 0) {}
+
+    void reserve(int) {}
+
+    bool empty() const {
+        return pq.empty();
+    }
+
+    void push(int node, int key) {
+        pq.push({key, node});
+    }
+
+    int pop() {
+        int node = pq.top().second;
+        pq.pop();
+        return node;
+    }
+
+    void clear() {
+        pq = {};
+    }
+
+    void release() {
+        clear();
+    }
+};
+
+// Indexed d-ary min-heap with decrease-key: each node is queued at most once, so
+// the heap never holds more than the open set and no stale entry is ever popped.
+// A wider node means a shallower heap and sift-downs that scan one cache line.
+template <int Arity = 4>
+class IndexedHeap {
+private:
+    vector<pair<int, int>> heap;  // (key, node)
+    vector<int> position;         // index in heap per node, -1 if not queued
+
+    void place(int i, pair<int, int> item) {
+        heap[i] = item;
+        position[item.second] = i;
+    }
+
+    void siftUp(int i) {
+        pair<int, int> item = heap[i];
+        while (i > 0) {
+            int parent = (i - 1) / Arity;
+            if (heap[parent] <= item) break;
+            place(i, heap[parent]);
+            i = parent;
+        }
+        place(i, item);
+    }
+
+    void siftDown(int i) {
+        pair<int, int> item = heap[i];
+        int count = heap.size();
+        while (true) {
+            int first = i * Arity + 1;
+            if (first >= count) break;
+            int best = first;
+            for (int c = first + 1; c < min(first + Arity, count); c++) {
+                if (heap[c] < heap[best]) best = c;
+            }
+            if (item <= heap[best]) break;
+            place(i, heap[best]);
+            i = best;
+        }
+        place(i, item);
+    }
+
+public:
+    explicit IndexedHeap(int nodeCount = 0) : position(nodeCount, -1) {}
+
+    bool empty() const {
+        return heap.empty();
+    }
+
+    size_t size() const {
+        return heap.size();
+    }
+
+    bool contains(int node) const {
+        return position[node] >= 0;
+    }
+
+    int topKey() const {
+        return heap[0].first;
+    }
+
+    // Room for node ids below nodeCount; an empty heap can be reused for a larger graph
+    void reserve(int nodeCount) {
+        if ((int)position.size() < nodeCount) position.resize(nodeCount, -1);
+    }
+
+    // Insert, or lower the key of a queued node (a higher key is ignored)
+    void push(int node, int key) {
+        int i = position[node];
+        if (i < 0) {
+            i = heap.size();
+            heap.push_back({key, node});
+        } else if (key < heap[i].first) {
+            heap[i].first = key;
+        } else {
+            return;
+        }
+        siftUp(i);
+    }
+
+    int pop() {
+        int node = heap[0].second;
+        position[node] = -1;
+        pair<int, int> last = heap.back();
+        heap.pop_back();
+        if (!heap.empty()) {
+            heap[0] = last;
+            siftDown(0);
+        }
+        return node;
+    }
+
+    // Empty the heap in O(size), leaving it ready for another search
+    void clear() {
+        for (const auto& item : heap) position[item.second] = -1;
+        heap.clear();
+    }
+
+    void release() {
+        vector<pair<int, int>>().swap(heap);
+        vector<int>().swap(position);
+    }
+
+    // Queued (key, node) pairs in heap order
+    const vector<pair<int, int>>& items() const {
+        return heap;
+    }
+};
+
+// Radix heap for non-negative integer keys that never drop below the last key
+// popped, as in Dijkstra and A* with a consistent bound. Entries sit in buckets
+// by the highest bit in which their key differs from the last popped key; each
+// entry moves to a lower bucket at most 32 times, so pops cost O(1) amortized
+// plus the bucket scan, with no comparisons between entries. Lazy.
+class RadixHeap {
+private:
+    vector<pair<uint32_t, int>> buckets[33];  // (key, node)
+    uint32_t last = 0;
+    size_t count = 0;
+
+    static int bitLength(uint32_t x) {
+        int bits = 0;
+        if (x >> 16) { bits += 16; x >>= 16; }
+        if (x >> 8) { bits += 8; x >>= 8; }
+        if (x >> 4) { bits += 4; x >>= 4; }
+        if (x >> 2) { bits += 2; x >>= 2; }
+        if (x >> 1) { bits += 1; x >>= 1; }
+        return bits + x;
+    }
+
+    int bucketOf(uint32_t key) const {
+        return bitLength(key ^ last);
+    }
+
+public:
+    explicit RadixHeap(int = 0) {}
+
+    void reserve(int) {}
+
+    bool empty() const {
+        return count == 0;
+    }
+
+    void push(int node, int key) {
+        buckets[bucketOf(key)].push_back({(uint32_t)key, node});
+        count++;
+    }
+
+    int pop() {
+        if (buckets[0].empty()) {
+            int b = 1;
+            while (buckets[b].empty()) b++;
+            last = min_element(buckets[b].begin(), buckets[b].end())->first;
+            for (const auto& entry : buckets[b]) buckets[bucketOf(entry.first)].push_back(entry);
+            buckets[b].clear();
+        }
+        int node = buckets[0].back().second;
+        buckets[0].pop_back();
+        count--;
+        return node;
+    }
+
+    void clear() {
+        for (auto& bucket : buckets) bucket.clear();
+        last = 0;
+        count = 0;
+    }
+
+    void release() {
+        for (auto& bucket : buckets) vector<pair<uint32_t, int>>().swap(bucket);
+        last = 0;
+        count = 0;
+    }
+};
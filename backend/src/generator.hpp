@@ -0,0 +1,205 @@
+#pragma once
+#include "graph.hpp"
+#include <vector>
+#include <string>
+#include <cmath>
+#include <cstdint>
+#include <stdexcept>
+
+using namespace std;
+
+// Small deterministic generator (SplitMix64). Unlike <random> distributions its
+// output is the same on every compiler, so a seed always gives the same graph.
+class SplitMix64 {
+private:
+    uint64_t state;
+
+public:
+    SplitMix64(uint64_t seed) : state(seed) {}
+
+    uint64_t next() {
+        uint64_t z = (state += 0x9e3779b97f4a7c15ULL);
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+        return z ^ (z >> 31);
+    }
+
+    // Uniform in [0, 1)
+    double uniform() {
+        return (next() >> 11) * (1.0 / 9007199254740992.0);
+    }
+
+    // Uniform in [0, n)
+    int below(int n) {
+        return static_cast<int>(next() % static_cast<uint64_t>(n));
+    }
+};
+
+// Helpers shared by the generators
+class GraphGenerator {
+private:
+    SplitMix64 rng;
+
+    const char* nodeType() {
+        static const char* types[] = {"building", "library", "cafeteria", "hostel", "lab", "parking", "sports", "admin"};
+        return types[rng.below(8)];
+    }
+
+    const char* pathType() {
+        double r = rng.uniform();
+        if (r < 0.70) return "walkway";
+        if (r < 0.92) return "road";
+        return "stairs";
+    }
+
+    // Walking distance: straight-line length with a little detour, at least 1 m.
+    // Rounded up so no edge is shorter than its coordinates, which keeps A* bounds tight.
+    int walkWeight(const Graph& g, int a, int b) {
+        const Node& u = g.getNode(a);
+        const Node& v = g.getNode(b);
+        double length = hypot(u.x - v.x, u.y - v.y) * (1.0 + 0.3 * rng.uniform());
+        return max(1, static_cast<int>(ceil(length)));
+    }
+
+    void connect(Graph& g, int a, int b, const char* type = nullptr) {
+        g.addEdge(a, b, walkWeight(g, a, b), type ? type : pathType());
+    }
+
+    // Random geometric graph over nodes [first, g.size()): join pairs closer than radius.
+    // Points are bucketed into radius-sized cells so only neighbouring cells are compared.
+    void joinNearby(Graph& g, int first, double radius) {
+        int count = g.size() - first;
+        if (count <= 1) return;
+
+        double minX = g.getNode(first).x, maxX = minX, minY = g.getNode(first).y, maxY = minY;
+        for (int i = first; i < g.size(); i++) {
+            minX = min(minX, g.getNode(i).x); maxX = max(maxX, g.getNode(i).x);
+            minY = min(minY, g.getNode(i).y); maxY = max(maxY, g.getNode(i).y);
+        }
+        int cols = max(1, static_cast<int>((maxX - minX) / radius) + 1);
+        int rows = max(1, static_cast<int>((maxY - minY) / radius) + 1);
+
+        // Counting sort of nodes into cells
+        vector<int> cellOf(count), cellStart(static_cast<size_t>(cols) * rows + 1, 0), sorted(count);
+        for (int i = 0; i < count; i++) {
+            const Node& n = g.getNode(first + i);
+            int cx = static_cast<int>((n.x - minX) / radius);
+            int cy = static_cast<int>((n.y - minY) / radius);
+            cellOf[i] = cy * cols + cx;
+            cellStart[cellOf[i] + 1]++;
+        }
+        for (size_t c = 0; c + 1 < cellStart.size(); c++) cellStart[c + 1] += cellStart[c];
+        vector<int> fill(cellStart.begin(), cellStart.end() - 1);
+        for (int i = 0; i < count; i++) sorted[fill[cellOf[i]]++] = first + i;
+
+        double r2 = radius * radius;
+        for (int i = 0; i < count; i++) {
+            int a = first + i;
+            const Node& u = g.getNode(a);
+            int cx = cellOf[i] % cols, cy = cellOf[i] / cols;
+            for (int dy = -1; dy <= 1; dy++) {
+                for (int dx = -1; dx <= 1; dx++) {
+                    int x = cx + dx, y = cy + dy;
+                    if (x < 0 || y < 0 || x >= cols || y >= rows) continue;
+                    int cell = y * cols + x;
+                    for (int k = cellStart[cell]; k < cellStart[cell + 1]; k++) {
+                        int b = sorted[k];
+                        if (b <= a) continue;  // each pair once
+                        const Node& v = g.getNode(b);
+                        double ddx = u.x - v.x, ddy = u.y - v.y;
+                        if (ddx * ddx + ddy * ddy <= r2) connect(g, a, b);
+                    }
+                }
+            }
+        }
+    }
+
+    // Place count random points in a square and join them geometrically (average degree ~6)
+    void addGeometricCluster(Graph& g, int count, double centerX, double centerY, double side,
+                             const string& namePrefix) {
+        int first = g.size();
+        for (int i = 0; i < count; i++) {
+            double x = centerX + (rng.uniform() - 0.5) * side;
+            double y = centerY + (rng.uniform() - 0.5) * side;
+            g.addNode(g.size(), namePrefix + to_string(i), x, y, nodeType());
+        }
+        double radius = sqrt(6.0 * side * side / (3.14159265358979 * max(count, 1)));
+        joinNearby(g, first, radius);
+    }
+
+public:
+    GraphGenerator(uint64_t seed) : rng(seed) {}
+
+    // rows x cols street grid, 50 m blocks with jittered corners; ~10% of links are missing
+    Graph grid(int nodeCount) {
+        int cols = max(1, static_cast<int>(ceil(sqrt(static_cast<double>(nodeCount)))));
+        Graph g(nodeCount);
+        for (int i = 0; i < nodeCount; i++) {
+            double x = (i % cols) * 50.0 + rng.uniform() * 10.0;
+            double y = (i / cols) * 50.0 + rng.uniform() * 10.0;
+            g.addNode(i, "Node " + to_string(i), x, y, nodeType());
+        }
+        for (int i = 0; i < nodeCount; i++) {
+            bool right = (i % cols) + 1 < cols && i + 1 < nodeCount;
+            bool down = i + cols < nodeCount;
+            if (right && rng.uniform() < 0.9) connect(g, i, i + 1);
+            if (down && rng.uniform() < 0.9) connect(g, i, i + cols);
+        }
+        g.finalize();
+        return g;
+    }
+
+    // Uniform random points in a square sized for ~50 m spacing, joined within a radius
+    Graph geometric(int nodeCount) {
+        double side = 50.0 * sqrt(static_cast<double>(nodeCount));
+        Graph g(nodeCount);
+        addGeometricCluster(g, nodeCount, side / 2, side / 2, side, "Node ");
+        g.finalize();
+        return g;
+    }
+
+    // "Campus of campuses": dense geometric campuses on a coarse grid,
+    // each linked to its right and lower neighbour by a few roads
+    Graph clustered(int nodeCount, int campusSize = 1000) {
+        int campuses = max(1, nodeCount / campusSize);
+        int campusCols = max(1, static_cast<int>(ceil(sqrt(static_cast<double>(campuses)))));
+        double side = 50.0 * sqrt(static_cast<double>(campusSize));
+        double spacing = side * 2;
+
+        Graph g(nodeCount);
+        vector<int> firstNode;
+        for (int c = 0; c < campuses; c++) {
+            int count = (c == campuses - 1) ? nodeCount - g.size() : campusSize;
+            firstNode.push_back(g.size());
+            double cx = (c % campusCols) * spacing;
+            double cy = (c / campusCols) * spacing;
+            addGeometricCluster(g, count, cx, cy, side, "Campus " + to_string(c) + " Building ");
+        }
+        firstNode.push_back(g.size());
+
+        // Roads between neighbouring campuses, joining random buildings on each side
+        for (int c = 0; c < campuses; c++) {
+            int neighbours[] = {(c % campusCols) + 1 < campusCols ? c + 1 : -1, c + campusCols};
+            for (int other : neighbours) {
+                if (other < 0 || other >= campuses) continue;
+                for (int road = 0; road < 3; road++) {
+                    int a = firstNode[c] + rng.below(firstNode[c + 1] - firstNode[c]);
+                    int b = firstNode[other] + rng.below(firstNode[other + 1] - firstNode[other]);
+                    connect(g, a, b, "road");
+                }
+            }
+        }
+        g.finalize();
+        return g;
+    }
+};
+
+// Generate a graph by kind name: "grid", "geometric" or "clustered"
+Graph generateGraph(const string& kind, int nodeCount, uint64_t seed) {
+    if (nodeCount <= 0) throw invalid_argument("Node count must be positive");
+    GraphGenerator generator(seed);
+    if (kind == "grid") return generator.grid(nodeCount);
+    if (kind == "geometric") return generator.geometric(nodeCount);
+    if (kind == "clustered") return generator.clustered(nodeCount);
+    throw invalid_argument("Unknown graph kind: " + kind);
+}
@@ -1,8 +1,15 @@
 #pragma once
 #include <vector>
 #include <string>
-#include <map>
 #include <limits>
+#include <cstdint>
+#include <algorithm>
+#include <cmath>
+#include "name_index.hpp"
+#include "spatial_index.hpp"
+#include "time_profile.hpp"
+#include "routing_profile.hpp"
+#include "disjoint_set.hpp"
 
 using namespace std;
 
@@ -25,49 +32,589 @@ struct Edge{
     int from, to;
     int weight; //distance in meters
     string pathType;//"walkway","road","stairs"
+    bool closed; //temporarily out of use, kept for display but not routed over
+    int profile; //travel-time profile over the day, -1 for a fixed walking time
+    uint8_t attributes; //EDGE_STAIRS, EDGE_COVERED, ... bits
 
     Edge(int f, int t, int w, string pt="walkway")
-    :from(f), to(t), weight(w), pathType(pt){}
+    :from(f), to(t), weight(w), pathType(pt), closed(false), profile(-1), attributes(defaultEdgeAttributes(pt)){}
+};
+
+//Neighbor= one entry in a node's adjacency row
+struct Neighbor{
+    int to;
+    int weight;
+    int pathType; //index into Graph::getPathTypes()
+    int edge; //index into Graph::getEdges()
+};
+
+//Compact adjacency encoding used by Graph::setCompressedAdjacency. Per neighbor, in target order:
+//  varint( (zigzag(to - previous target) << pathTypeBits) | pathType )   previous starts at the row's node
+//  weight as 2 little-endian bytes if every weight fits in 16 bits, else as a varint
+struct PackedRowFormat{
+    int pathTypeBits = 0;
+    bool shortWeights = true;
+};
+
+//Neighbors of one node, usable in range-for without allocating. Walks the CSR
+//array directly, or decodes a packed row one neighbor at a time.
+class NeighborRange{
+    public:
+    class iterator{
+        private:
+        const Neighbor* entry; //CSR mode
+        const uint8_t* at; //packed mode: start of the current neighbor
+        const uint8_t* next; //packed mode: start of the one after it
+        const uint8_t* stop;
+        PackedRowFormat format;
+        Neighbor value;
+
+        static const uint8_t* readVarint(const uint8_t* p, uint64_t& out){
+            out = 0;
+            for(int shift=0; ; shift += 7){
+                uint8_t byte = *p++;
+                out |= uint64_t(byte & 0x7f) << shift;
+                if(!(byte & 0x80)) return p;
+            }
+        }
+
+        void decode(){
+            uint64_t head;
+            const uint8_t* p = readVarint(at, head);
+            uint64_t zig = head >> format.pathTypeBits;
+            int64_t delta = (zig >> 1) ^ -(int64_t)(zig & 1);
+            value.to += (int)delta;
+            value.pathType = (int)(head & ((1u << format.pathTypeBits) - 1));
+            if(format.shortWeights){
+                value.weight = p[0] | (p[1] << 8);
+                p += 2;
+            }
+            else{
+                uint64_t w;
+                p = readVarint(p, w);
+                value.weight = (int)w;
+            }
+            next = p;
+        }
+
+        public:
+        iterator(const Neighbor* e) : entry(e), at(nullptr), next(nullptr), stop(nullptr), value() {}
+        iterator(const uint8_t* a, const uint8_t* s, PackedRowFormat f, int node)
+        : entry(nullptr), at(a), next(a), stop(s), format(f), value{node, 0, 0, -1}{
+            if(at != stop) decode();
+        }
+
+        const Neighbor& operator*() const { return entry ? *entry : value; }
+        const Neighbor* operator->() const { return &**this; }
+
+        iterator& operator++(){
+            if(entry) ++entry;
+            else{
+                at = next;
+                if(at != stop) decode();
+            }
+            return *this;
+        }
+
+        bool operator==(const iterator& other) const { return entry == other.entry && at == other.at; }
+        bool operator!=(const iterator& other) const { return !(*this == other); }
+    };
+
+    private:
+    iterator first, last;
+    size_t count;
+
+    public:
+    NeighborRange(const Neighbor* b, const Neighbor* e) : first(b), last(e), count(e - b) {}
+    NeighborRange(const uint8_t* b, const uint8_t* e, PackedRowFormat f, int node, size_t n)
+    : first(b, e, f, node), last(e, e, f, node), count(n) {}
+
+    iterator begin() const { return first; }
+    iterator end() const { return last; }
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
 };
 
 //Graph class
 class Graph{
     private:
     vector<Node> nodes;
-    vector<vector<int>> adjMatrix;
     vector<Edge> edges;
-    map<string, int> nameToId;
+    NameIndex nameIndex;
+    KdTree spatialIndex;
+
+    //Adjacency in CSR form: the row of node u is adjacency[adjOffset[u] .. adjOffset[u+1])
+    vector<int> adjOffset;
+    vector<Neighbor> adjacency;
+
+    //Compressed mode replaces `adjacency` with packed rows: node u's row is
+    //packed[packedOffset[u] .. packedOffset[u+1]). Edge ids are not stored (Neighbor::edge is -1).
+    bool compressed = false;
+    vector<uint64_t> packedOffset;
+    vector<uint8_t> packed;
+    PackedRowFormat packedFormat;
+    vector<string> pathTypes;
+    uint64_t version = 0;
+
+    //Time-dependent travel times. slotProfile gives the profile of each adjacency slot
+    //(adjOffset[u] + position in u's row), so it also works with packed rows; empty if no edge has one.
+    TravelTimeProfiles profiles;
+    vector<int> slotProfile;
+
+    //Routing profile costs per adjacency slot, compiled whenever the adjacency is rebuilt.
+    //Entry p-1 belongs to routingProfiles()[p]; profile 0 uses Neighbor::weight.
+    vector<vector<int>> profileWeights;
+
+    //Per routing profile, the largest s with s * straight-line length <= cost on every usable
+    //edge, for static costs and for travel seconds. Scales the Euclidean A* bound; 1 when
+    //weights are meters measured along straight paths, smaller if coordinates overstate distances.
+    vector<double> boundScale, timedBoundScale;
+
+    //Connected component of each node over the open edges, numbered 0.. in order of first node
+    vector<int> componentOf;
+    int componentCount = 0;
+
+    //Partition cells (see partition.hpp), empty if the graph is not partitioned. The boundary
+    //nodes of cell c (those with an edge into another cell) are cellBoundary[cellBoundaryOffset[c] .. [c+1]).
+    vector<int> cellOf;
+    int cellCount = 0;
+    vector<int> cellBoundaryOffset;
+    vector<int> cellBoundary;
+    int cutEdges = 0;
+
+    //Internal ids are positions in `nodes`; Node::id is the stable external id used by the API.
+    //Both maps are empty while the two coincide (no renumbering).
+    vector<int> externalIds; //internal -> external
+    vector<int> internalIds; //external -> internal
+
+    static void writeVarint(vector<uint8_t>& out, uint64_t value){
+        while(value >= 0x80){
+            out.push_back(uint8_t(value) | 0x80);
+            value >>= 7;
+        }
+        out.push_back(uint8_t(value));
+    }
+
+    //Encode the CSR rows into packed form and release the CSR array
+    void packAdjacency(){
+        int n = nodes.size();
+        packedFormat.pathTypeBits = 0;
+        while((1u << packedFormat.pathTypeBits) < pathTypes.size()) packedFormat.pathTypeBits++;
+        packedFormat.shortWeights = true;
+        for(const auto& nb : adjacency){
+            if(nb.weight < 0 || nb.weight > 0xffff) packedFormat.shortWeights = false;
+        }
+
+        packed.clear();
+        packedOffset.assign(n + 1, 0);
+        for(int u=0; u< n; u++){
+            packedOffset[u] = packed.size();
+            int previous = u;
+            for(int i=adjOffset[u]; i< adjOffset[u + 1]; i++){
+                const Neighbor& nb = adjacency[i];
+                int64_t delta = (int64_t)nb.to - previous;
+                uint64_t zig = ((uint64_t)delta << 1) ^ (uint64_t)(delta >> 63);
+                writeVarint(packed, (zig << packedFormat.pathTypeBits) | (uint64_t)nb.pathType);
+                if(packedFormat.shortWeights){
+                    packed.push_back(uint8_t(nb.weight));
+                    packed.push_back(uint8_t(nb.weight >> 8));
+                }
+                else{
+                    writeVarint(packed, (uint64_t)nb.weight);
+                }
+                previous = nb.to;
+            }
+        }
+        packedOffset[n] = packed.size();
+        packed.shrink_to_fit();
+        vector<Neighbor>().swap(adjacency);
+    }
+
+    //Derive the boundary nodes and cut size of the cells. Closed edges count too:
+    //closures are temporary and the partition describes the network itself.
+    void indexCells(){
+        cellBoundaryOffset.assign(cellCount + 1, 0);
+        cellBoundary.clear();
+        cutEdges = 0;
+        if(cellOf.empty()) return;
+
+        int n = nodes.size();
+        vector<char> boundary(n, 0);
+        for(const auto& e : edges){
+            if(cellOf[e.from] != cellOf[e.to]){
+                cutEdges++;
+                boundary[e.from] = boundary[e.to] = 1;
+            }
+        }
+        for(int u=0; u< n; u++){
+            if(boundary[u]) cellBoundaryOffset[cellOf[u] + 1]++;
+        }
+        for(int c=0; c< cellCount; c++) cellBoundaryOffset[c + 1] += cellBoundaryOffset[c];
+        cellBoundary.resize(cellBoundaryOffset[cellCount]);
+        vector<int> fill(cellBoundaryOffset.begin(), cellBoundaryOffset.end() - 1);
+        for(int u=0; u< n; u++){
+            if(boundary[u]) cellBoundary[fill[cellOf[u]]++] = u;
+        }
+    }
+
+    int internPathType(const string& pathType){
+        for(size_t i=0; i< pathTypes.size(); i++){
+            if(pathTypes[i] == pathType) return i;
+        }
+        pathTypes.push_back(pathType);
+        return pathTypes.size() - 1;
+    }
 
     public:
     Graph(int size){
-        adjMatrix.resize(size, vector<int>(size,0));
         nodes.reserve(size);
     }
 
     void addNode(int id, string name, double x, double y, string type="building"){
         nodes.push_back(Node(id, name, x, y, type));
-        nameToId[name]= id;
     }
 
     void addEdge(int from, int to, int weight, string pathType="walkway"){
         if(from >= 0 && from < (int)nodes.size() && to >= 0 && to < (int)nodes.size()){
-            adjMatrix[from][to] = weight;
-            adjMatrix[to][from] = weight;
             edges.push_back(Edge(from, to, weight, pathType));
         }
     }
 
+    //Build the adjacency rows, name index and spatial index. Call once after the last addEdge.
+    //perfectNameIndex trades a slower build for single-probe name lookups on graphs that never change.
+    void finalize(bool perfectNameIndex=false){
+        rebuildAdjacency();
+
+        vector<string> names;
+        names.reserve(nodes.size());
+        for(const auto& node : nodes) names.push_back(node.name);
+        if(perfectNameIndex) nameIndex.buildPerfect(names);
+        else nameIndex.build(names);
+
+        vector<KdTree::Point> points;
+        points.reserve(nodes.size());
+        for(size_t i=0; i< nodes.size(); i++) points.push_back({nodes[i].x, nodes[i].y, (int)i});
+        spatialIndex.build(move(points));
+    }
+
+    //Rebuild only the adjacency rows, after edge weights or closures changed
+    void rebuildAdjacency(){
+        int n = nodes.size();
+        adjOffset.assign(n + 1, 0);
+        for(const auto& e : edges){
+            if(e.closed) continue;
+            adjOffset[e.from + 1]++;
+            adjOffset[e.to + 1]++;
+        }
+        for(int i=0; i< n; i++){
+            adjOffset[i + 1] += adjOffset[i];
+        }
+
+        adjacency.resize(adjOffset[n]);
+        vector<int> fill(adjOffset.begin(), adjOffset.end() - 1);
+        for(size_t i=0; i< edges.size(); i++){
+            const Edge& e = edges[i];
+            if(e.closed) continue;
+            int pt = internPathType(e.pathType);
+            adjacency[fill[e.from]++] = {e.to, e.weight, pt, (int)i};
+            adjacency[fill[e.to]++] = {e.from, e.weight, pt, (int)i};
+        }
+
+        //Keep each row ordered by target so scans visit neighbors in id order
+        for(int u=0; u< n; u++){
+            sort(adjacency.begin() + adjOffset[u], adjacency.begin() + adjOffset[u + 1],
+                 [](const Neighbor& a, const Neighbor& b){ return a.to < b.to; });
+        }
+
+        slotProfile.clear();
+        bool anyProfile = false;
+        for(const auto& e : edges) anyProfile = anyProfile || e.profile >= 0;
+        if(anyProfile){
+            slotProfile.resize(adjacency.size());
+            for(size_t i=0; i< adjacency.size(); i++) slotProfile[i] = edges[adjacency[i].edge].profile;
+        }
+
+        //Edge closures can split components, which union-find cannot undo, so relabel from scratch
+        DisjointSet sets(n);
+        for(const auto& e : edges){
+            if(!e.closed) sets.unite(e.from, e.to);
+        }
+        componentOf.resize(n);
+        vector<int> label(n, -1);
+        componentCount = 0;
+        for(int u=0; u< n; u++){
+            int root = sets.find(u);
+            if(label[root] < 0) label[root] = componentCount++;
+            componentOf[u] = label[root];
+        }
+
+        const auto& routing = routingProfiles();
+        profileWeights.assign(routing.size() - 1, vector<int>(adjacency.size()));
+        for(size_t p=1; p< routing.size(); p++){
+            vector<int>& weights = profileWeights[p - 1];
+            for(size_t i=0; i< adjacency.size(); i++){
+                const Edge& e = edges[adjacency[i].edge];
+                weights[i] = routing[p].cost(e.weight, e.attributes);
+            }
+        }
+
+        boundScale.assign(routing.size(), INFINITY);
+        timedBoundScale.assign(routing.size(), INFINITY);
+        for(int u=0; u< n; u++){
+            for(int i=adjOffset[u]; i< adjOffset[u + 1]; i++){
+                const Node& to = nodes[adjacency[i].to];
+                double straight = hypot(to.x - nodes[u].x, to.y - nodes[u].y);
+                if(straight <= 0) continue;
+                for(size_t p=0; p< routing.size(); p++){
+                    int cost = p == 0 ? adjacency[i].weight : profileWeights[p - 1][i];
+                    if(cost == INF) continue;
+                    int seconds = minimumSeconds(i, cost);
+                    boundScale[p] = min(boundScale[p], cost / straight);
+                    timedBoundScale[p] = min(timedBoundScale[p], seconds / straight);
+                }
+            }
+        }
+        //Slightly under the exact ratio so rounding cannot make the bound inconsistent
+        for(auto* scales : {&boundScale, &timedBoundScale}){
+            for(double& scale : *scales) scale = isinf(scale) ? 0 : scale * (1 - 1e-9);
+        }
+
+        if(compressed) packAdjacency();
+    }
+
+    //Switch between plain CSR rows (16 bytes per neighbor) and packed rows (typically 3-5 bytes).
+    //Packed rows cost a little decoding per neighbor and do not carry edge ids.
+    void setCompressedAdjacency(bool enable){
+        if(enable == compressed) return;
+        compressed = enable;
+        if(!compressed){
+            vector<uint64_t>().swap(packedOffset);
+            vector<uint8_t>().swap(packed);
+        }
+        rebuildAdjacency();
+    }
+
+    bool isCompressed() const{
+        return compressed;
+    }
+
+    //Permute node storage so that internal id k holds the node that was at order[k].
+    //External ids (Node::id) stay the same; use toInternal/toExternal at the API boundary.
+    void renumber(const vector<int>& order){
+        int n = nodes.size();
+        vector<int> newId(n);
+        for(int k=0; k< n; k++) newId[order[k]] = k;
+
+        vector<Node> reordered;
+        reordered.reserve(n);
+        for(int k=0; k< n; k++) reordered.push_back(move(nodes[order[k]]));
+        nodes.swap(reordered);
+
+        for(auto& e : edges){
+            e.from = newId[e.from];
+            e.to = newId[e.to];
+        }
+
+        if(!cellOf.empty()){
+            vector<int> cells(n);
+            for(int k=0; k< n; k++) cells[k] = cellOf[order[k]];
+            cellOf.swap(cells);
+            indexCells();
+        }
+
+        externalIds.resize(n);
+        internalIds.assign(n, -1);
+        for(int k=0; k< n; k++){
+            externalIds[k] = nodes[k].id;
+            if(nodes[k].id >= 0 && nodes[k].id < n) internalIds[nodes[k].id] = k;
+        }
+        finalize(nameIndex.isPerfect());
+    }
+
+    //Record the external id of every internal node (e.g. when loading a renumbered snapshot)
+    void setExternalIds(const vector<int>& ids){
+        int n = nodes.size();
+        externalIds = ids;
+        internalIds.assign(n, -1);
+        for(int k=0; k< n; k++){
+            nodes[k].id = ids[k];
+            if(ids[k] >= 0 && ids[k] < n) internalIds[ids[k]] = k;
+        }
+    }
+
+    bool isRenumbered() const{
+        return !externalIds.empty();
+    }
+
+    const vector<int>& getExternalIds() const{
+        return externalIds;
+    }
+
+    //External (API) id -> internal id, -1 if unknown
+    int toInternal(int externalId) const{
+        if(externalId < 0 || externalId >= (int)nodes.size()) return -1;
+        return externalIds.empty() ? externalId : internalIds[externalId];
+    }
+
+    //Internal id -> external (API) id; -1 stays -1
+    int toExternal(int internalId) const{
+        if(internalId < 0 || externalIds.empty()) return internalId;
+        return externalIds[internalId];
+    }
+
+    //Index of the edge joining two nodes (either direction), -1 if none
+    int findEdge(int from, int to) const{
+        if(from < 0 || from >= (int)nodes.size()) return -1;
+        for(const auto& nb : neighbors(from)){
+            if(nb.to == to && nb.edge >= 0) return nb.edge;
+        }
+        //Closed edges are not in the adjacency (and packed rows have no edge ids), fall back to the edge list
+        for(size_t i=0; i< edges.size(); i++){
+            const Edge& e = edges[i];
+            if((e.from == from && e.to == to) || (e.from == to && e.to == from)) return i;
+        }
+        return -1;
+    }
+
+    //Edge mutations only touch the edge list; call rebuildAdjacency() afterwards
+    void setEdgeWeight(int edgeId, int weight){
+        edges[edgeId].weight = weight;
+    }
+
+    void setEdgeClosed(int edgeId, bool closed){
+        edges[edgeId].closed = closed;
+    }
+
+    void setEdgeAttributes(int edgeId, uint8_t attributes){
+        edges[edgeId].attributes = attributes;
+    }
+
+    //Give an edge a travel-time profile; an empty profile restores the fixed walking time.
+    //Replaced profiles stay in the pool until the graph is rebuilt from a snapshot.
+    void setEdgeProfile(int edgeId, const vector<ProfilePoint>& profile){
+        edges[edgeId].profile = profile.empty() ? -1 : profiles.add(profile);
+    }
+
+    //Restore profiles saved in a snapshot; edgeProfiles has one entry per edge
+    void restoreProfiles(vector<ProfilePoint> points, vector<uint32_t> offsets, const vector<int>& edgeProfiles){
+        profiles.assign(move(points), move(offsets));
+        for(size_t i=0; i< edges.size() && i< edgeProfiles.size(); i++){
+            if(edgeProfiles[i] >= (int)profiles.count()) throw runtime_error("Edge refers to an unknown profile");
+            edges[i].profile = edgeProfiles[i];
+        }
+    }
+
+    const TravelTimeProfiles& getProfiles() const{
+        return profiles;
+    }
+
+    bool hasTimeProfiles() const{
+        return !slotProfile.empty();
+    }
+
+    //Adjacency slot of the first neighbor of a node; slots of its row are consecutive
+    int rowOffset(int nodeId) const{
+        return adjOffset[nodeId];
+    }
+
+    //Component label of a node; nodes in different components have no route between them
+    int getComponent(int nodeId) const{
+        return componentOf[nodeId];
+    }
+
+    int getComponentCount() const{
+        return componentCount;
+    }
+
+    bool connected(int a, int b) const{
+        return componentOf[a] == componentOf[b];
+    }
+
+    //Assign every node to a partition cell numbered 0..; an empty vector removes the partition
+    void setCells(const vector<int>& cells){
+        if(!cells.empty() && cells.size() != nodes.size()) throw invalid_argument("Partition needs one cell per node");
+        cellCount = 0;
+        for(int c : cells){
+            if(c < 0) throw invalid_argument("Partition cells must be non-negative");
+            cellCount = max(cellCount, c + 1);
+        }
+        cellOf = cells;
+        indexCells();
+    }
+
+    bool hasCells() const{
+        return !cellOf.empty();
+    }
+
+    const vector<int>& getCells() const{
+        return cellOf;
+    }
+
+    int getCell(int nodeId) const{
+        return cellOf[nodeId];
+    }
+
+    int getCellCount() const{
+        return cellCount;
+    }
+
+    //Number of edges whose ends lie in different cells
+    int getCutSize() const{
+        return cutEdges;
+    }
+
+    //Nodes of a cell that have an edge into another cell, in id order
+    vector<int> getCellBoundary(int cell) const{
+        return vector<int>(cellBoundary.begin() + cellBoundaryOffset[cell], cellBoundary.begin() + cellBoundaryOffset[cell + 1]);
+    }
+
+    //Cost of every adjacency slot under a routing profile (index into routingProfiles()),
+    //INF for unusable edges; null for profile 0, whose costs are the plain weights
+    const int* routingWeights(int routingProfile) const{
+        return routingProfile > 0 ? profileWeights[routingProfile - 1].data() : nullptr;
+    }
+
+    //Scale of the Euclidean A* bound for a routing profile, timed (seconds) or static costs
+    double getBoundScale(int routingProfile, bool timed) const{
+        return timed ? timedBoundScale[routingProfile] : boundScale[routingProfile];
+    }
+
+    //Seconds to cross the neighbor in adjacency slot `slot` when entering at time `when`
+    int travelSeconds(int slot, int weight, long long when) const{
+        if(!slotProfile.empty() && slotProfile[slot] >= 0) return profiles.evaluate(slotProfile[slot], when);
+        return max(1, (int)(weight / WALKING_SPEED + 0.5));
+    }
+
+    //Fewest seconds travelSeconds can return for this slot at any time of day
+    int minimumSeconds(int slot, int weight) const{
+        if(!slotProfile.empty() && slotProfile[slot] >= 0) return profiles.minimum(slotProfile[slot]);
+        return max(1, (int)(weight / WALKING_SPEED + 0.5));
+    }
+
+    //Monotonic version number, bumped each time a changed copy of the graph is published
+    uint64_t getVersion() const{
+        return version;
+    }
+
+    void setVersion(uint64_t v){
+        version = v;
+    }
+
+    //Case-insensitive name lookup, -1 if no node has that name
     int getNodeId(const string& name) const{
-        auto it = nameToId.find(name);
-        return (it != nameToId.end()) ? it->second : -1;
+        return nameIndex.find(name);
     }
 
     const Node& getNode(int id) const {
         return nodes[id];
     }
 
+    //Weight of the direct path between two nodes, 0 if they are not adjacent
     int getWeight(int from, int to) const {
-        return adjMatrix[from][to];
+        for(const auto& nb : neighbors(from)){
+            if(nb.to == to) return nb.weight;
+        }
+        return 0;
     }
 
     int size() const {
@@ -82,14 +629,50 @@ class Graph{
         return edges;
     }
 
-    vector<int> getNeighbors(int nodeId) const{
-        vector<int> neighbors;
-        for(size_t i=0; i< nodes.size(); i++){
-            if(adjMatrix[nodeId][i]>0){
-                neighbors.push_back(i);
-            }
+    const vector<string>& getPathTypes() const{
+        return pathTypes;
+    }
+
+    //Up to k closest nodes to a point as (distance, node id), closest first
+    vector<pair<double, int>> nearestNodes(double x, double y, int k) const{
+        return spatialIndex.nearest(x, y, k);
+    }
+
+    //Ids of the nodes inside a rectangle
+    vector<int> nodesInBox(double minX, double minY, double maxX, double maxY) const{
+        return spatialIndex.inBox(minX, minY, maxX, maxY);
+    }
+
+    //Approximate heap bytes held by the graph, used for memory budgets
+    size_t memoryUsage() const{
+        size_t bytes = nodes.capacity() * sizeof(Node) + edges.capacity() * sizeof(Edge)
+                     + adjOffset.capacity() * sizeof(int) + adjacency.capacity() * sizeof(Neighbor)
+                     + packedOffset.capacity() * sizeof(uint64_t) + packed.capacity()
+                     + (externalIds.capacity() + internalIds.capacity()) * sizeof(int)
+                     + profiles.memoryUsage() + slotProfile.capacity() * sizeof(int)
+                     + componentOf.capacity() * sizeof(int)
+                     + (cellOf.capacity() + cellBoundaryOffset.capacity() + cellBoundary.capacity()) * sizeof(int)
+                     + nameIndex.memoryUsage() + spatialIndex.memoryUsage();
+        for(const auto& weights : profileWeights) bytes += weights.capacity() * sizeof(int);
+        for(const auto& node : nodes){
+            if(node.name.capacity() > 15) bytes += node.name.capacity() + 1;
+            if(node.type.capacity() > 15) bytes += node.type.capacity() + 1;
         }
-        return neighbors;
+        for(const auto& e : edges){
+            if(e.pathType.capacity() > 15) bytes += e.pathType.capacity() + 1;
+        }
+        return bytes;
+    }
+
+    //Neighbors of a node as a view into the adjacency (no allocation)
+    NeighborRange neighbors(int nodeId) const{
+        if(compressed){
+            const uint8_t* row = packed.data();
+            return NeighborRange(row + packedOffset[nodeId], row + packedOffset[nodeId + 1],
+                                 packedFormat, nodeId, adjOffset[nodeId + 1] - adjOffset[nodeId]);
+        }
+        const Neighbor* row = adjacency.data();
+        return NeighborRange(row + adjOffset[nodeId], row + adjOffset[nodeId + 1]);
     }
 };
 
@@ -123,6 +706,6 @@ Graph createCampusGraph(){
     g.addEdge(5, 8, 210, "walkway"); // Hostel to Lab
     g.addEdge(6, 8, 180, "walkway"); // Parking Lot to Lab
    
-    
+    g.finalize();
     return g;
 }
\ No newline at end of file
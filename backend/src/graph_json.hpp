@@ -0,0 +1,80 @@
+#pragma once
+#include "graph.hpp"
+#include "../lib/json.hpp"
+#include <string>
+#include <vector>
+#include <stdexcept>
+
+using json = nlohmann::json;
+using namespace std;
+
+// JSON form of a node as used by every endpoint
+json nodeToJSON(const Node& node) {
+    return {
+        {"id", node.id},
+        {"name", node.name},
+        {"x", node.x},
+        {"y", node.y},
+        {"type", node.type}
+    };
+}
+
+// Travel-time profile as JSON: [{"time": "08:00", "seconds": 240}, ...]
+json profileToJSON(const vector<ProfilePoint>& profile) {
+    json points = json::array();
+    for (const auto& p : profile) {
+        string time = formatTimeOfDay(p.time);
+        if (p.time % 60) time += ":" + string(p.time % 60 < 10 ? "0" : "") + to_string(p.time % 60);
+        points.push_back({{"time", time}, {"seconds", p.seconds}});
+    }
+    return points;
+}
+
+vector<ProfilePoint> profileFromJSON(const json& points) {
+    if (!points.is_array()) throw invalid_argument("Profile must be an array of {time, seconds}");
+    vector<ProfilePoint> profile;
+    for (const auto& p : points) {
+        profile.push_back({parseTimeOfDay(p.at("time").get<string>()), p.at("seconds").get<int>()});
+    }
+    return profile;
+}
+
+// JSON form of an edge, with external node ids. The id is the edge's index, which never changes.
+json edgeToJSON(const Graph& g, int edgeId) {
+    const Edge& edge = g.getEdges()[edgeId];
+    json edgeData = {
+        {"id", edgeId},
+        {"from", g.toExternal(edge.from)},
+        {"to", g.toExternal(edge.to)},
+        {"weight", edge.weight},
+        {"type", edge.pathType},
+        {"closed", edge.closed},
+        {"attributes", edgeAttributeNames(edge.attributes)}
+    };
+    if (edge.profile >= 0) {
+        edgeData["profile"] = profileToJSON(g.getProfiles().get(edge.profile));
+    }
+    return edgeData;
+}
+
+// The whole graph as served by /api/graph
+json graphToJSON(const Graph& g) {
+    json graphData;
+    graphData["version"] = g.getVersion();
+    graphData["nodes"] = json::array();
+    graphData["edges"] = json::array();
+
+    // In external id order, so clients can index nodes by id
+    for (int id = 0; id < g.size(); id++) {
+        int internal = g.toInternal(id);
+        json nodeData = nodeToJSON(g.getNode(internal));
+        nodeData["component"] = g.getComponent(internal);
+        graphData["nodes"].push_back(nodeData);
+    }
+    graphData["componentCount"] = g.getComponentCount();
+
+    for (size_t i = 0; i < g.getEdges().size(); i++) {
+        graphData["edges"].push_back(edgeToJSON(g, i));
+    }
+    return graphData;
+}
@@ -0,0 +1,344 @@
+#pragma once
+#include "graph.hpp"
+#include "graph_json.hpp"
+#include "tiles.hpp"
+#include "ch.hpp"
+#include "landmarks.hpp"
+#include "all_pairs.hpp"
+#include "../lib/json.hpp"
+#include <memory>
+#include <atomic>
+#include <mutex>
+#include <deque>
+#include <set>
+#include <iostream>
+#include <stdexcept>
+
+using json = nlohmann::json;
+using namespace std;
+
+// Holds the current version of a graph and publishes changed copies (read-copy-update).
+// Readers take a snapshot() and use it for the whole query without locking; a writer
+// copies the current graph, applies its changes, and swaps the pointer atomically.
+// An old version is freed when the last query holding its snapshot finishes.
+class GraphStore {
+private:
+    shared_ptr<const Graph> current;
+    mutex writeMutex;  // serializes writers only
+    bool readOnly = false;  // set while the campus is written back and unloaded (guarded by writeMutex)
+
+    // Map tiles of the latest graph version that asked for them, built on first use
+    shared_ptr<const TileIndex> tileIndex;
+    mutable mutex tileMutex;
+
+    // Contraction hierarchy; comes with the snapshot or is built by a background job
+    // on first use, and rebuilt the same way after edge changes make it stale
+    shared_ptr<const ContractionHierarchy> contractionHierarchy;
+    mutable mutex hierarchyMutex;
+    atomic<bool> hierarchyBuilding{false};
+
+    // ALT landmark tables, only for campuses that were given some; recomputed with
+    // the same number of landmarks by a background job after edge changes
+    shared_ptr<const LandmarkTables> landmarkTables;
+    mutable mutex landmarkMutex;
+    atomic<bool> landmarksBuilding{false};
+
+    // All-pairs tables, only for campuses loaded with them. Edge changes leave the
+    // table stale until a background job has built one for the new version.
+    shared_ptr<const AllPairsTable> allPairsTable;
+    mutable mutex allPairsMutex;
+    atomic<bool> allPairsBuilding{false};
+
+    // Change journal: what each of the last journalLimit versions changed.
+    // Entry i turned version journalBase + i into journalBase + i + 1.
+    struct JournalEntry {
+        vector<int> edges;
+        vector<int> nodes;  // internal ids of nodes whose component label changed
+    };
+    static const size_t journalLimit = 1024;
+    deque<JournalEntry> journal;
+    uint64_t journalBase;
+    mutable mutex journalMutex;
+
+    // Bring a per-version structure up to the current snapshot; meant for background
+    // jobs. Only one build per structure runs at a time, it repeats while more
+    // updates arrive, and a result never replaces one built for a newer version.
+    // Unless `create` is set, a structure the campus does not have is left alone.
+    template <typename T, typename Build>
+    void refresh(shared_ptr<const T>& slot, mutex& slotMutex, atomic<bool>& building, bool create, Build build) {
+        auto current = [&](uint64_t version) {
+            lock_guard<mutex> lock(slotMutex);
+            return slot ? slot->getVersion() >= version : !create;
+        };
+        while (!building.exchange(true)) {
+            try {
+                shared_ptr<const Graph> graph;
+                while (!current((graph = snapshot())->getVersion())) {
+                    shared_ptr<const T> previous;
+                    {
+                        lock_guard<mutex> lock(slotMutex);
+                        previous = slot;
+                    }
+                    auto built = make_shared<const T>(build(*graph, previous.get()));
+                    lock_guard<mutex> lock(slotMutex);
+                    if (!slot || slot->getVersion() < built->getVersion()) slot = move(built);
+                }
+            } catch (const exception& e) {
+                building = false;
+                cout << "Background rebuild failed: " << e.what() << endl;
+                return;
+            }
+            building = false;
+
+            // An update published just before the flag was cleared found a build running
+            if (current(snapshot()->getVersion())) return;
+        }
+    }
+
+public:
+    GraphStore(Graph g) : current(make_shared<const Graph>(move(g))), journalBase(current->getVersion()) {}
+
+    shared_ptr<const Graph> snapshot() const {
+        return atomic_load(&current);
+    }
+
+    void publish(shared_ptr<const Graph> next) {
+        atomic_store(&current, move(next));
+    }
+
+    // Reject edge updates from now on, once any update in progress has finished.
+    // The registry does this before writing an evicted campus back to disk, so
+    // requests still holding this store cannot change it after the write.
+    void setReadOnly(bool value) {
+        lock_guard<mutex> lock(writeMutex);
+        readOnly = value;
+    }
+
+    // Current graph plus the tiles and routing structures kept for it, in bytes
+    size_t memoryUsage() const {
+        size_t bytes = snapshot()->memoryUsage();
+        {
+            lock_guard<mutex> lock(tileMutex);
+            if (tileIndex) bytes += tileIndex->memoryUsage();
+        }
+        shared_ptr<const ContractionHierarchy> ch = cachedHierarchy();
+        shared_ptr<const LandmarkTables> tables = cachedLandmarks();
+        if (ch) bytes += ch->memoryUsage();
+        if (tables) bytes += tables->memoryUsage();
+        lock_guard<mutex> lock(allPairsMutex);
+        if (allPairsTable) bytes += allPairsTable->memoryUsage();
+        return bytes;
+    }
+
+    // Tile index for a graph snapshot taken from this store
+    shared_ptr<const TileIndex> tiles(const Graph& graph) {
+        lock_guard<mutex> lock(tileMutex);
+        if (!tileIndex || tileIndex->getVersion() != graph.getVersion()) {
+            tileIndex = make_shared<const TileIndex>(graph);
+        }
+        return tileIndex;
+    }
+
+    // Contraction hierarchy for a graph snapshot taken from this store, or null while
+    // none has been built for its version (callers then search and refreshHierarchy())
+    shared_ptr<const ContractionHierarchy> hierarchy(const Graph& graph) const {
+        lock_guard<mutex> lock(hierarchyMutex);
+        if (!contractionHierarchy || contractionHierarchy->getVersion() != graph.getVersion()) return nullptr;
+        return contractionHierarchy;
+    }
+
+    bool hasHierarchy() const {
+        lock_guard<mutex> lock(hierarchyMutex);
+        return contractionHierarchy != nullptr;
+    }
+
+    // Build the hierarchy for the current version on up to `threads` threads (0 for
+    // all cores); takes seconds on large campuses
+    void refreshHierarchy(unsigned threads = 0) {
+        refresh(contractionHierarchy, hierarchyMutex, hierarchyBuilding, true,
+                [threads](const Graph& graph, const ContractionHierarchy*) {
+                    return buildContractionHierarchy(graph, threads);
+                });
+    }
+
+    // Hierarchy as it is right now (null or stale if never built for the current version)
+    shared_ptr<const ContractionHierarchy> cachedHierarchy() const {
+        lock_guard<mutex> lock(hierarchyMutex);
+        return contractionHierarchy;
+    }
+
+    void setHierarchy(shared_ptr<const ContractionHierarchy> ch) {
+        lock_guard<mutex> lock(hierarchyMutex);
+        contractionHierarchy = move(ch);
+    }
+
+    // Landmark tables for a graph snapshot taken from this store; null without landmarks
+    // or while they are stale (callers then use the straight-line bound)
+    shared_ptr<const LandmarkTables> landmarks(const Graph& graph) const {
+        lock_guard<mutex> lock(landmarkMutex);
+        if (!landmarkTables || landmarkTables->getVersion() != graph.getVersion()) return nullptr;
+        return landmarkTables;
+    }
+
+    bool hasLandmarks() const {
+        lock_guard<mutex> lock(landmarkMutex);
+        return landmarkTables != nullptr;
+    }
+
+    // Recompute the landmark tables for the current version on up to `threads`
+    // threads; meant for a background job after edge updates
+    void refreshLandmarks(unsigned threads = 0) {
+        refresh(landmarkTables, landmarkMutex, landmarksBuilding, false,
+                [threads](const Graph& graph, const LandmarkTables* previous) {
+                    return LandmarkTables::build(graph, previous->getCount(), threads);
+                });
+    }
+
+    shared_ptr<const LandmarkTables> cachedLandmarks() const {
+        lock_guard<mutex> lock(landmarkMutex);
+        return landmarkTables;
+    }
+
+    void setLandmarks(shared_ptr<const LandmarkTables> tables) {
+        lock_guard<mutex> lock(landmarkMutex);
+        landmarkTables = move(tables);
+    }
+
+    // All-pairs table if it matches the snapshot; null otherwise (queries then search)
+    shared_ptr<const AllPairsTable> allPairs(const Graph& graph) const {
+        lock_guard<mutex> lock(allPairsMutex);
+        if (!allPairsTable || allPairsTable->getVersion() != graph.getVersion()) return nullptr;
+        return allPairsTable;
+    }
+
+    bool hasAllPairs() const {
+        lock_guard<mutex> lock(allPairsMutex);
+        return allPairsTable != nullptr;
+    }
+
+    void setAllPairs(shared_ptr<const AllPairsTable> table) {
+        lock_guard<mutex> lock(allPairsMutex);
+        allPairsTable = move(table);
+    }
+
+    // Bring the all-pairs table up to the current version on up to `threads` threads;
+    // meant for a background job after edge updates
+    void refreshAllPairs(unsigned threads = 0) {
+        refresh(allPairsTable, allPairsMutex, allPairsBuilding, false,
+                [threads](const Graph& graph, const AllPairsTable*) { return AllPairsTable::build(graph, threads); });
+    }
+
+    // Apply a batch of edge changes as one new version:
+    // {"updates": [{"from": 0, "to": 1, "weight": 300}, {"from": 2, "to": 6, "closed": true}]}
+    // "profile": [{"time": "HH:MM", "seconds": s}, ...] sets a travel-time profile, null removes it.
+    // "attributes": ["covered", "lit", ...] replaces the edge's attribute set.
+    // The batch is all-or-nothing; an unknown edge or bad weight rejects it.
+    json applyEdgeUpdates(const json& body) {
+        lock_guard<mutex> lock(writeMutex);
+        if (readOnly) throw runtime_error("Campus is being unloaded; retry the update");
+        shared_ptr<const Graph> base = snapshot();
+        Graph next = *base;
+
+        if (!body.contains("updates") || !body["updates"].is_array()) {
+            throw invalid_argument("Body must contain an \"updates\" array");
+        }
+
+        int applied = 0;
+        vector<int> touched;
+        for (const auto& update : body["updates"]) {
+            int from = update.at("from").get<int>();
+            int to = update.at("to").get<int>();
+            int edgeId = next.findEdge(next.toInternal(from), next.toInternal(to));
+            if (edgeId == -1) {
+                throw invalid_argument("No edge between " + to_string(from) + " and " + to_string(to));
+            }
+            if (update.contains("weight")) {
+                int weight = update["weight"].get<int>();
+                if (weight <= 0) throw invalid_argument("Edge weight must be positive");
+                next.setEdgeWeight(edgeId, weight);
+            }
+            if (update.contains("closed")) {
+                next.setEdgeClosed(edgeId, update["closed"].get<bool>());
+            }
+            if (update.contains("attributes")) {
+                uint8_t attributes = 0;
+                for (const auto& name : update["attributes"]) attributes |= edgeAttributeBit(name.get<string>());
+                next.setEdgeAttributes(edgeId, attributes);
+            }
+            if (update.contains("profile")) {
+                const json& profile = update["profile"];
+                next.setEdgeProfile(edgeId, profile.is_null() ? vector<ProfilePoint>() : profileFromJSON(profile));
+            }
+            touched.push_back(edgeId);
+            applied++;
+        }
+
+        next.setVersion(base->getVersion() + 1);
+        next.rebuildAdjacency();
+
+        JournalEntry entry;
+        entry.edges = move(touched);
+        for (int u = 0; u < next.size(); u++) {
+            if (next.getComponent(u) != base->getComponent(u)) entry.nodes.push_back(u);
+        }
+        {
+            lock_guard<mutex> lock(journalMutex);
+            journal.push_back(move(entry));
+            if (journal.size() > journalLimit) {
+                journal.pop_front();
+                journalBase++;
+            }
+        }
+        publish(make_shared<const Graph>(move(next)));
+
+        json result;
+        result["version"] = base->getVersion() + 1;
+        result["applied"] = applied;
+        return result;
+    }
+
+    // What changed in `graph` (a snapshot of this store) after version `since`:
+    // {"version", "since", "full": false, "nodes": {...}, "edges": {"added", "modified", "removed"}}.
+    // Edges and nodes are listed in their current state; nodes only change when edge
+    // closures move them to another component, and nothing is added or removed yet.
+    // If the journal no longer reaches back to `since` (or `since` is from another
+    // lifetime of the graph) the answer is the whole graph with "full": true.
+    json changesSince(const Graph& graph, uint64_t since) const {
+        set<int> edgeIds, nodeIds;
+        bool covered;
+        {
+            lock_guard<mutex> lock(journalMutex);
+            covered = since >= journalBase && since <= graph.getVersion() &&
+                      graph.getVersion() - journalBase <= journal.size();
+            for (uint64_t v = since; covered && v < graph.getVersion(); v++) {
+                const JournalEntry& entry = journal[v - journalBase];
+                edgeIds.insert(entry.edges.begin(), entry.edges.end());
+                nodeIds.insert(entry.nodes.begin(), entry.nodes.end());
+            }
+        }
+
+        if (!covered) {
+            json result = graphToJSON(graph);
+            result["since"] = since;
+            result["full"] = true;
+            return result;
+        }
+
+        json result;
+        result["version"] = graph.getVersion();
+        result["since"] = since;
+        result["full"] = false;
+        result["nodes"] = {{"added", json::array()}, {"modified", json::array()}, {"removed", json::array()}};
+        result["edges"] = {{"added", json::array()}, {"modified", json::array()}, {"removed", json::array()}};
+        result["componentCount"] = graph.getComponentCount();
+        for (int id : nodeIds) {
+            json nodeData = nodeToJSON(graph.getNode(id));
+            nodeData["component"] = graph.getComponent(id);
+            result["nodes"]["modified"].push_back(nodeData);
+        }
+        for (int id : edgeIds) {
+            result["edges"]["modified"].push_back(edgeToJSON(graph, id));
+        }
+        return result;
+    }
+};
@@ -0,0 +1,61 @@
+#pragma once
+#include "graph.hpp"
+#include "landmarks.hpp"
+#include <cmath>
+#include <cstdlib>
+
+using namespace std;
+
+// Lower bound on the remaining cost from any node to one target, for goal-directed
+// (A*) search. It is consistent: bound(u) <= cost(u, v) + bound(v) on every usable
+// edge, so each node is still settled once and a settled cost is final.
+// A default-constructed bound is 0 everywhere, which leaves plain Dijkstra.
+class RemainingBound {
+private:
+    const Graph* graph = nullptr;
+    double scale = 0;
+    double targetX = 0, targetY = 0;
+    const int* landmarkDist = nullptr;  // landmarkCount distances per node
+    const int* targetDist = nullptr;
+    int landmarkCount = 0;
+
+public:
+    RemainingBound() {}
+
+    // Straight-line distance to the target times the graph's bound scale for this
+    // profile (see Graph::getBoundScale), in the units the search minimises
+    static RemainingBound euclidean(const Graph& g, int target, int routingProfile, bool timed) {
+        RemainingBound bound;
+        bound.graph = &g;
+        bound.scale = g.getBoundScale(routingProfile, timed);
+        bound.targetX = g.getNode(target).x;
+        bound.targetY = g.getNode(target).y;
+        return bound;
+    }
+
+    // The straight-line bound raised to the best landmark bound (ALT); the maximum
+    // of consistent bounds is consistent
+    static RemainingBound landmarks(const Graph& g, const LandmarkTables& tables, int target, int routingProfile,
+                                    bool timed) {
+        RemainingBound bound = euclidean(g, target, routingProfile, timed);
+        bound.landmarkCount = tables.getCount();
+        bound.landmarkDist = tables.distances(routingProfile, timed);
+        bound.targetDist = bound.landmarkDist + (size_t)target * bound.landmarkCount;
+        return bound;
+    }
+
+    // Rounded down, which keeps the bound consistent for integer edge costs
+    int operator()(int v) const {
+        int best = 0;
+        if (scale != 0) {
+            const Node& node = graph->getNode(v);
+            double dx = node.x - targetX, dy = node.y - targetY;
+            best = static_cast<int>(scale * sqrt(dx * dx + dy * dy));
+        }
+        const int* row = landmarkDist + (size_t)v * landmarkCount;
+        for (int k = 0; k < landmarkCount; k++) {
+            if (row[k] != INF && targetDist[k] != INF) best = max(best, abs(row[k] - targetDist[k]));
+        }
+        return best;
+    }
+};
@@ -0,0 +1,174 @@
+#pragma once
+#include "graph.hpp"
+#include "snapshot.hpp"
+#include "parallel.hpp"
+#include "routing_profile.hpp"
+#include <queue>
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <cstdlib>
+#include <algorithm>
+#include <stdexcept>
+
+using namespace std;
+
+// Landmark distance tables for ALT (A*, landmarks, triangle inequality). For a
+// landmark L, |d(v, L) - d(t, L)| <= d(v, t): a lower bound that follows the edge
+// costs rather than the coordinates, so it stays tight when costs are profile
+// penalties or travel times. Edges are undirected, so one table serves distances
+// both from and to a landmark. Each routing profile has two metrics: its static
+// costs, and for timed (depart) searches the fewest seconds each edge can take.
+class LandmarkTables {
+private:
+    uint64_t version = 0;          // graph version the tables were computed for
+    vector<int> landmarks;
+    vector<vector<int>> tables;    // per metric, landmarks.size() distances per node
+
+public:
+    static int metric(int routingProfile, bool timed) {
+        return routingProfile * 2 + (timed ? 1 : 0);
+    }
+
+    static int metricCount() {
+        return routingProfiles().size() * 2;
+    }
+
+    // Distances from one node to all others under a metric (INF if unreachable)
+    static vector<int> distancesFrom(const Graph& g, int source, int m) {
+        const int* profileCost = g.routingWeights(m / 2);
+        bool timed = m % 2 == 1;
+        vector<int> dist(g.size(), INF);
+        priority_queue<pair<int, int>, vector<pair<int, int>>, greater<pair<int, int>>> pq;
+        dist[source] = 0;
+        pq.push({0, source});
+        while (!pq.empty()) {
+            int d = pq.top().first, u = pq.top().second;
+            pq.pop();
+            if (d > dist[u]) continue;
+            int slot = g.rowOffset(u);
+            for (const Neighbor& nb : g.neighbors(u)) {
+                int cost = profileCost ? profileCost[slot] : nb.weight;
+                if (cost != INF && timed) cost = g.minimumSeconds(slot, cost);
+                slot++;
+                if (cost == INF || d + cost >= dist[nb.to]) continue;
+                dist[nb.to] = d + cost;
+                pq.push({dist[nb.to], nb.to});
+            }
+        }
+        return dist;
+    }
+
+    LandmarkTables() {}
+
+    LandmarkTables(uint64_t graphVersion, vector<int> nodes, vector<vector<int>> distances)
+        : version(graphVersion), landmarks(move(nodes)), tables(move(distances)) {
+        bool valid = (int)tables.size() == metricCount() && !landmarks.empty();
+        for (const auto& table : tables) valid = valid && table.size() % landmarks.size() == 0 && table.size() == tables[0].size();
+        if (!valid) throw runtime_error("Inconsistent landmark tables");
+    }
+
+    // Farthest-point selection: the first landmark is the node farthest from the start
+    // of the largest component, each next one the node farthest from all chosen so far
+    // (walking distance). Only that component gets landmarks; other pairs fall back to
+    // the straight-line bound. The remaining metrics are computed in parallel.
+    static LandmarkTables build(const Graph& g, int landmarkCount, unsigned threads = 0) {
+        if (landmarkCount < 1) throw invalid_argument("Landmark count must be at least 1");
+        int n = g.size();
+        if (n == 0) throw invalid_argument("Cannot place landmarks in an empty graph");
+
+        vector<int> componentSize(g.getComponentCount(), 0);
+        for (int u = 0; u < n; u++) componentSize[g.getComponent(u)]++;
+        int largest = max_element(componentSize.begin(), componentSize.end()) - componentSize.begin();
+        int seed = 0;
+        while (g.getComponent(seed) != largest) seed++;
+
+        vector<int> nearest = distancesFrom(g, seed, 0);  // distance to the closest landmark (the seed at first)
+        vector<int> nodes;
+        vector<vector<int>> walking;
+        while ((int)nodes.size() < landmarkCount) {
+            int next = -1;
+            for (int u = 0; u < n; u++) {
+                if (nearest[u] != INF && (next < 0 || nearest[u] > nearest[next])) next = u;
+            }
+            if (!nodes.empty() && nearest[next] == 0) break;  // every node is a landmark already
+            nodes.push_back(next);
+            walking.push_back(distancesFrom(g, next, 0));
+            for (int u = 0; u < n; u++) nearest[u] = min(nearest[u], walking.back()[u]);
+        }
+
+        int k = nodes.size();
+        vector<vector<int>> distances(metricCount(), vector<int>((size_t)n * k));
+        for (int i = 0; i < k; i++) {
+            for (int u = 0; u < n; u++) distances[0][(size_t)u * k + i] = walking[i][u];
+        }
+        vector<vector<int>>().swap(walking);
+        parallelFor((metricCount() - 1) * k, [&](size_t job, unsigned) {
+            int m = 1 + job / k, i = job % k;
+            vector<int> column = distancesFrom(g, nodes[i], m);
+            for (int u = 0; u < n; u++) distances[m][(size_t)u * k + i] = column[u];
+        }, threads);
+        return LandmarkTables(g.getVersion(), move(nodes), move(distances));
+    }
+
+    uint64_t getVersion() const {
+        return version;
+    }
+
+    int getCount() const {
+        return landmarks.size();
+    }
+
+    const vector<int>& getLandmarks() const {
+        return landmarks;
+    }
+
+    int nodeCount() const {
+        return tables[0].size() / landmarks.size();
+    }
+
+    // getCount() distances per node, node-major
+    const int* distances(int routingProfile, bool timed) const {
+        return tables[metric(routingProfile, timed)].data();
+    }
+
+    size_t memoryUsage() const {
+        size_t bytes = landmarks.capacity() * sizeof(int);
+        for (const auto& table : tables) bytes += table.capacity() * sizeof(int);
+        return bytes;
+    }
+
+    // Same tables after Graph::renumber: node i is now newId[i]
+    LandmarkTables renumbered(const vector<int>& newId) const {
+        int k = landmarks.size(), n = nodeCount();
+        vector<int> nodes(k);
+        for (int i = 0; i < k; i++) nodes[i] = newId[landmarks[i]];
+        vector<vector<int>> distances(tables.size(), vector<int>(tables[0].size()));
+        for (size_t m = 0; m < tables.size(); m++) {
+            for (int u = 0; u < n; u++) {
+                copy(tables[m].begin() + (size_t)u * k, tables[m].begin() + (size_t)(u + 1) * k,
+                     distances[m].begin() + (size_t)newId[u] * k);
+            }
+        }
+        return LandmarkTables(version, move(nodes), move(distances));
+    }
+
+    // Snapshot section "LMRK"
+    string toSection() const {
+        ByteWriter out;
+        out.put<uint64_t>(version);
+        out.putArray(landmarks);
+        out.put<uint32_t>(tables.size());
+        for (const auto& table : tables) out.putArray(table);
+        return out.str();
+    }
+
+    static LandmarkTables fromSection(const string& bytes) {
+        ByteReader in(bytes);
+        uint64_t graphVersion = in.get<uint64_t>();
+        vector<int> nodes = in.getArray<int>();
+        vector<vector<int>> distances(in.get<uint32_t>());
+        for (auto& table : distances) table = in.getArray<int>();
+        return LandmarkTables(graphVersion, move(nodes), move(distances));
+    }
+};
@@ -4,9 +4,22 @@
 #include <winsock2.h>
 #include <ws2tcpip.h>
 #include <sstream>
+#include <chrono>
+#include <memory>
 
 #include "graph.hpp"
+#include "graph_store.hpp"
+#include "campus_registry.hpp"
+#include "thread_pool.hpp"
+#include "generator.hpp"
+#include "osm_import.hpp"
+#include "partition.hpp"
 #include "dijkstra.hpp"
+#include "bidirectional.hpp"
+#include "ch.hpp"
+#include "matrix.hpp"
+#include "all_pairs.hpp"
+#include "route_cache.hpp"
 #include "search.hpp"
 #include "sort.hpp"
 #include "utils.hpp"
@@ -15,15 +28,32 @@
 using namespace std;
 using json = nlohmann::json;
 
-// Global campus graph
-Graph campusGraph = createCampusGraph();
+// All hosted campuses; "main" is the built-in campus served by the unprefixed /api/... routes.
+// Each request works on the graph snapshot current when it started.
+const string defaultCampus = "main";
+unique_ptr<CampusRegistry> registry;
+
+// Responses of recent route queries, shared by all campuses
+unique_ptr<RouteCache> routeCache;
+
+// Worker threads for connections
+unique_ptr<ThreadPool> pool;
+
+// Rebuilds of routing structures after edge changes, kept off the connection
+// workers: one job at a time, each using at most buildThreads threads
+unique_ptr<ThreadPool> background;
+unsigned buildThreads = 1;
 
 // Send HTTP response
-void sendResponse(int clientSocket, const string& content, const string& contentType = "application/json") {
+// extraHeaders are complete header lines, each ending in \r\n
+void sendResponse(int clientSocket, const string& content, const string& contentType = "application/json",
+                  const string& extraHeaders = "") {
     ostringstream response;
     response << "HTTP/1.1 200 OK\r\n";
     response << "Content-Type: " << contentType << "\r\n";
     response << "Access-Control-Allow-Origin: *\r\n";
+    response << "Access-Control-Expose-Headers: ETag\r\n";
+    response << extraHeaders;
     response << "Content-Length: " << content.length() << "\r\n";
     response << "Connection: close\r\n";
     response << "\r\n";
@@ -33,6 +63,29 @@ void sendResponse(int clientSocket, const string& content, const string& content
     send(clientSocket, responseStr.c_str(), static_cast<int>(responseStr.length()), 0);
 }
 
+// Tell a client its cached copy (matching the ETag) is still current
+void sendNotModified(int clientSocket, const string& etag) {
+    ostringstream response;
+    response << "HTTP/1.1 304 Not Modified\r\n";
+    response << "ETag: " << etag << "\r\n";
+    response << "Access-Control-Allow-Origin: *\r\n";
+    response << "Connection: close\r\n";
+    response << "\r\n";
+
+    string responseStr = response.str();
+    send(clientSocket, responseStr.c_str(), static_cast<int>(responseStr.length()), 0);
+}
+
+// Serve cacheable content: 304 if the client already has this ETag, else the content
+// with the ETag attached. Clients revalidate every time, since edge updates change content.
+void sendCacheable(int clientSocket, const string& request, const string& etag, const string& content) {
+    if (extractHeader(request, "If-None-Match") == etag) {
+        sendNotModified(clientSocket, etag);
+        return;
+    }
+    sendResponse(clientSocket, content, "application/json", "ETag: " + etag + "\r\nCache-Control: no-cache\r\n");
+}
+
 // Send 404 error
 void send404(int clientSocket) {
     string content = "{\"error\": \"Endpoint not found\"}";
@@ -48,49 +101,352 @@ void send404(int clientSocket) {
     send(clientSocket, responseStr.c_str(), static_cast<int>(responseStr.length()), 0);
 }
 
+// Resolve a route endpoint given by id (start=3), name (from=Library) or
+// coordinates (fromX=410&fromY=160, snapped to the nearest node)
+int resolveNode(const Graph& g, map<string, string>& params, const string& idKey, const string& nameKey) {
+    int id;
+    if (params.count(nameKey + "X")) {
+        auto nearest = g.nearestNodes(stod(params[nameKey + "X"]), stod(params[nameKey + "Y"]), 1);
+        id = nearest.empty() ? -1 : nearest[0].second;
+    }
+    else if (params.count(nameKey)) {
+        id = g.getNodeId(params[nameKey]);
+    }
+    else {
+        id = g.toInternal(stoi(params[idKey]));
+    }
+    
+    if (id < 0 || id >= g.size()) {
+        throw invalid_argument("Unknown location");
+    }
+    return id;
+}
+
+// Answer a CORS preflight so browsers may POST JSON
+void sendPreflight(int clientSocket) {
+    ostringstream response;
+    response << "HTTP/1.1 204 No Content\r\n";
+    response << "Access-Control-Allow-Origin: *\r\n";
+    response << "Access-Control-Allow-Methods: GET, POST, OPTIONS\r\n";
+    response << "Access-Control-Allow-Headers: Content-Type\r\n";
+    response << "Content-Length: 0\r\n";
+    response << "\r\n";
+    
+    string responseStr = response.str();
+    send(clientSocket, responseStr.c_str(), static_cast<int>(responseStr.length()), 0);
+}
+
+// Read a full request: headers, then as much body as Content-Length announces
+string receiveRequest(SOCKET clientSocket) {
+    const size_t maxRequestSize = 8 * 1024 * 1024;
+    string request;
+    char buffer[4096];
+    
+    while (request.size() < maxRequestSize) {
+        int bytesRead = recv(clientSocket, buffer, sizeof(buffer), 0);
+        if (bytesRead <= 0) break;
+        request.append(buffer, bytesRead);
+        
+        size_t headerEnd = request.find("\r\n\r\n");
+        if (headerEnd != string::npos &&
+            request.size() >= headerEnd + 4 + extractContentLength(request)) {
+            break;
+        }
+    }
+    return request;
+}
+
 // Handle API requests
 void handleRequest(int clientSocket, const string& request) {
+    string method = extractMethod(request);
     string path = extractPath(request);
     string queryString = extractQueryString(request);
     map<string, string> params = parseQueryParams(queryString);
     
-    cout << "Request: " << path << endl;
+    cout << "Request: " << method << " " << path << endl;
+    
+    if (method == "OPTIONS") {
+        sendPreflight(clientSocket);
+        return;
+    }
+    
+    // GET /api/campuses - Hosted campuses with their metrics
+    if (path == "/api/campuses") {
+        sendResponse(clientSocket, registry->toJSON().dump());
+        return;
+    }
+    
+    // /api/{campus}/dijkstra is routed like /api/dijkstra on that campus
+    string campusId = defaultCampus;
+    path = splitCampusPath(path, campusId);
+    
+    auto startTime = chrono::steady_clock::now();
+    CampusHandle handle;
+    bool failed = false;
     
     try {
-        // GET /api/graph - Return campus graph data
-        if (path == "/api/graph") {
-            json graphData;
-            graphData["nodes"] = json::array();
-            graphData["edges"] = json::array();
+        handle = registry->acquire(campusId);
+        GraphStore& store = *handle.store;
+        
+        // Pin one graph version for the whole request
+        shared_ptr<const Graph> graph = store.snapshot();
+        const Graph& campusGraph = *graph;
+        
+        // POST /api/edges - Change edge weights or close/reopen edges
+        if (path == "/api/edges" && method == "POST") {
+            json body = json::parse(extractBody(request));
+            json result = store.applyEdgeUpdates(body);
+            routeCache->invalidate(campusId, result["version"].get<uint64_t>());
+            shared_ptr<GraphStore> keep = handle.store;
+            if (store.hasAllPairs()) background->submit([keep]() { keep->refreshAllPairs(buildThreads); });
+            if (store.hasHierarchy()) background->submit([keep]() { keep->refreshHierarchy(buildThreads); });
+            if (store.hasLandmarks()) background->submit([keep]() { keep->refreshLandmarks(buildThreads); });
+            sendResponse(clientSocket, result.dump());
+        }
+        
+        // POST /api/matrix - Costs between many points in one request:
+        // {"sources": [0, 4], "targets": [2, 9], "profile": "walk", "format": "json"}
+        // "format": "binary" answers with raw row-major int32 values (-1 for no route).
+        // Walking matrices use the contraction hierarchy when the campus has a current one.
+        else if (path == "/api/matrix" && method == "POST") {
+            json body = json::parse(extractBody(request));
+            vector<int> ids[2];
+            const char* keys[2] = {"sources", "targets"};
+            for (int side = 0; side < 2; side++) {
+                for (const auto& id : body.at(keys[side])) {
+                    int internal = campusGraph.toInternal(id.get<int>());
+                    if (internal < 0) {
+                        throw invalid_argument("Unknown location: " + id.dump());
+                    }
+                    ids[side].push_back(internal);
+                }
+            }
+            int profile = body.contains("profile") ? findRoutingProfile(body["profile"].get<string>()) : 0;
+            if (profile < 0) {
+                throw invalid_argument("Unknown routing profile: " + body["profile"].get<string>());
+            }
+            string format = body.value("format", "json");
+            if (format != "json" && format != "binary") {
+                throw invalid_argument("format must be json or binary");
+            }
+            
+            shared_ptr<const ContractionHierarchy> ch = store.cachedHierarchy();
+            auto matrixStart = chrono::steady_clock::now();
+            DistanceMatrix matrix = computeMatrix(campusGraph, ch.get(), ids[0], ids[1], profile);
+            auto elapsed = chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now() - matrixStart);
+            if (format == "binary") {
+                sendResponse(clientSocket, matrixToBinary(matrix), "application/octet-stream",
+                             "X-Matrix-Rows: " + to_string(matrix.rows) + "\r\nX-Matrix-Columns: " +
+                             to_string(matrix.columns) + "\r\nX-Matrix-Method: " + matrix.method + "\r\n");
+            }
+            else {
+                json result = matrixToJSON(campusGraph, matrix, ids[0], ids[1], profile);
+                result["computeMicros"] = elapsed.count();
+                sendResponse(clientSocket, result.dump());
+            }
+        }
+        
+        // GET /api/metrics - Request counters for this campus
+        else if (path == "/api/metrics") {
+            json result = handle.campus->metrics.toJSON();
+            result["campus"] = campusId;
+            result["version"] = campusGraph.getVersion();
+            result["nodes"] = campusGraph.size();
+            result["bytes"] = campusGraph.memoryUsage();
+            result["boundScale"] = campusGraph.getBoundScale(0, false);
+            result["landmarks"] = store.hasLandmarks();  // whether algorithm=alt is available
+            result["routeCache"] = routeCache->toJSON();
+            sendResponse(clientSocket, result.dump());
+        }
+        
+        // GET /api/graph?bbox=minX,minY,maxX,maxY&zoom=2 - The tiles of one zoom level covering a
+        // rectangle (whole graph without bbox); coarse zooms only carry major paths
+        else if (path == "/api/graph" && (params.count("bbox") || params.count("zoom"))) {
+            shared_ptr<const TileIndex> tiles = store.tiles(campusGraph);
+            int zoom = params.count("zoom") ? min(max(stoi(params["zoom"]), 0), tiles->getMaxZoom()) : tiles->getMaxZoom();
+            double minX = -1e18, minY = -1e18, maxX = 1e18, maxY = 1e18;
+            if (params.count("bbox")) parseBoundingBox(params["bbox"], minX, minY, maxX, maxY);
             
-            for (const auto& node : campusGraph.getNodes()) {
-                graphData["nodes"].push_back({
-                    {"id", node.id},
-                    {"name", node.name},
-                    {"x", node.x},
-                    {"y", node.y},
-                    {"type", node.type}
-                });
+            vector<pair<int, int>> covered = tiles->tilesInBox(zoom, minX, minY, maxX, maxY);
+            string etag = "\"" + campusId + "-" + to_string(campusGraph.getVersion()) + "-" + to_string(zoom) + "-" +
+                          to_string(covered.front().first) + "." + to_string(covered.front().second) + "-" +
+                          to_string(covered.back().first) + "." + to_string(covered.back().second) + "\"";
+            
+            // Tiles are cached pre-rendered, so the response is spliced together as text
+            string content = "{\"version\":" + to_string(campusGraph.getVersion()) + ",\"zoom\":" + to_string(zoom) +
+                             ",\"grid\":" + tiles->gridJSON().dump() + ",\"tiles\":[";
+            for (size_t i = 0; i < covered.size(); i++) {
+                if (i > 0) content += ",";
+                content += tiles->tileJSON(campusGraph, zoom, covered[i].first, covered[i].second);
             }
+            content += "]}";
+            sendCacheable(clientSocket, request, etag, content);
+        }
+        
+        // GET /api/tile?z=2&x=1&y=3 - One map tile, for clients that cache tiles individually
+        else if (path == "/api/tile") {
+            shared_ptr<const TileIndex> tiles = store.tiles(campusGraph);
+            int zoom = stoi(params["z"]), x = stoi(params["x"]), y = stoi(params["y"]);
+            string content = tiles->tileJSON(campusGraph, zoom, x, y);
+            string etag = "\"" + campusId + "-" + to_string(campusGraph.getVersion()) + "-" + to_string(zoom) + "-" +
+                          to_string(x) + "." + to_string(y) + "\"";
+            sendCacheable(clientSocket, request, etag, content);
+        }
+        
+        // GET /api/graph?since=12 - Only what changed after version 12 (the whole graph if
+        // the change journal no longer goes back that far)
+        else if (path == "/api/graph" && params.count("since")) {
+            json result = store.changesSince(campusGraph, stoull(params["since"]));
+            sendResponse(clientSocket, result.dump());
+        }
+        
+        // GET /api/graph - Return campus graph data
+        else if (path == "/api/graph") {
+            sendResponse(clientSocket, graphToJSON(campusGraph).dump());
+        }
+        
+        // GET /api/nearest?x=400&y=300&k=3 - Closest nodes to a point
+        else if (path == "/api/nearest") {
+            double x = stod(params["x"]);
+            double y = stod(params["y"]);
+            int k = params.count("k") ? stoi(params["k"]) : 1;
+            if (k < 1) throw invalid_argument("k must be at least 1");
+            k = min(k, min(campusGraph.size(), 1000));  // keep the response bounded
             
-            for (const auto& edge : campusGraph.getEdges()) {
-                graphData["edges"].push_back({
-                    {"from", edge.from},
-                    {"to", edge.to},
-                    {"weight", edge.weight},
-                    {"type", edge.pathType}
-                });
+            json result;
+            result["nodes"] = json::array();
+            for (const auto& match : campusGraph.nearestNodes(x, y, k)) {
+                json node = nodeToJSON(campusGraph.getNode(match.second));
+                node["distance"] = match.first;
+                result["nodes"].push_back(node);
             }
+            sendResponse(clientSocket, result.dump());
+        }
+        
+        // GET /api/nodes?bbox=minX,minY,maxX,maxY - Nodes inside a rectangle
+        else if (path == "/api/nodes") {
+            double minX, minY, maxX, maxY;
+            parseBoundingBox(params["bbox"], minX, minY, maxX, maxY);
             
-            sendResponse(clientSocket, graphData.dump());
+            json result;
+            result["nodes"] = json::array();
+            for (int id : campusGraph.nodesInBox(minX, minY, maxX, maxY)) {
+                result["nodes"].push_back(nodeToJSON(campusGraph.getNode(id)));
+            }
+            sendResponse(clientSocket, result.dump());
         }
         
-        // GET /api/dijkstra?start=0&end=9
-        else if (path == "/api/dijkstra") {
-            int start = stoi(params["start"]);
-            int end = stoi(params["end"]);
+        // GET /api/dijkstra?start=0&end=9  or  ?from=Library&to=Hostel  or  ?fromX=..&fromY=..&toX=..&toY=..
+        // Add &depart=HH:MM for the fastest route leaving at that time of day,
+        // &profile=wheelchair|bike|night to route for that kind of traveller,
+        // &trace=none for just the path and distance (no visualization steps; required
+        // above maxTraceNodes nodes),
+        // &algorithm=astar for A* (GET /api/astar takes the same parameters),
+        // &algorithm=bidirectional to search from both ends (not with depart),
+        // &algorithm=ch for a contraction hierarchy query (walking only, always trace=none;
+        // answered by Dijkstra while the hierarchy is being built),
+        // &algorithm=alt for A* with landmark bounds (campuses with landmark tables;
+        // straight-line bounds while the tables are rebuilt after an edge change).
+        // Walking trace=none Dijkstra queries are read from the all-pairs table when
+        // the campus has a current one ("table": true in the result).
+        else if (path == "/api/dijkstra" || path == "/api/astar") {
+            int start = resolveNode(campusGraph, params, "start", "from");
+            int end = resolveNode(campusGraph, params, "end", "to");
+            int depart = params.count("depart") ? parseTimeOfDay(params["depart"]) : -1;
+            int profile = params.count("profile") ? findRoutingProfile(params["profile"]) : 0;
+            if (profile < 0) {
+                throw invalid_argument("Unknown routing profile: " + params["profile"]);
+            }
+            
+            string trace = params.count("trace") ? params["trace"] : "full";
+            if (trace != "full" && trace != "none") {
+                throw invalid_argument("trace must be full or none");
+            }
+            string algorithm = params.count("algorithm") ? params["algorithm"] : path == "/api/astar" ? "astar" : "dijkstra";
+            if (algorithm != "dijkstra" && algorithm != "astar" && algorithm != "bidirectional" && algorithm != "ch" &&
+                algorithm != "alt") {
+                throw invalid_argument("Unknown algorithm: " + algorithm);
+            }
+            if (trace == "full" && algorithm != "ch" && campusGraph.size() > maxTraceNodes) {
+                throw invalid_argument("trace=full is limited to graphs of " + to_string(maxTraceNodes) +
+                                       " nodes; use trace=none");
+            }
+            // A repeated query on the same graph version gets the stored response
+            string cacheKey = RouteCache::key(campusId, campusGraph.getVersion(),
+                                              to_string(start) + " " + to_string(end) + " " + algorithm + " " +
+                                              to_string(profile) + " " + to_string(depart) + " " + trace);
+            shared_ptr<const string> cached = routeCache->get(cacheKey);
+            if (cached) {
+                sendResponse(clientSocket, *cached);
+            }
+            else {
+                bool astar = algorithm == "astar" || algorithm == "alt";
+                bool cacheable = true;
+                shared_ptr<const LandmarkTables> landmarks;
+                if (algorithm == "alt") {
+                    if (!store.hasLandmarks()) {
+                        throw invalid_argument("Campus has no landmark tables (use --landmarks)");
+                    }
+                    landmarks = store.landmarks(campusGraph);
+                    if (!landmarks) {
+                        // Stale after an edge change: plain A* until the tables are rebuilt
+                        shared_ptr<GraphStore> keep = handle.store;
+                        background->submit([keep]() { keep->refreshLandmarks(buildThreads); });
+                        cacheable = false;
+                    }
+                }
+                shared_ptr<const AllPairsTable> table;
+                if (algorithm == "dijkstra" && trace == "none" && depart < 0 && profile == 0) {
+                    table = store.allPairs(campusGraph);
+                }
             
-            json result = getDijkstraPath(campusGraph, start, end);
+                json result;
+                if (algorithm == "ch") {
+                    if (depart >= 0 || profile != 0) {
+                        throw invalid_argument("Contraction hierarchy queries support only walking without depart");
+                    }
+                    shared_ptr<const ContractionHierarchy> ch = store.hierarchy(campusGraph);
+                    if (ch) {
+                        result = getHierarchyRoute(campusGraph, *ch, start, end);
+                    }
+                    else {
+                        // Built in the background; search until it is ready, without caching the answer
+                        shared_ptr<GraphStore> keep = handle.store;
+                        background->submit([keep]() { keep->refreshHierarchy(buildThreads); });
+                        result = getDijkstraRoute(campusGraph, start, end);
+                        cacheable = false;
+                    }
+                }
+                else if (algorithm == "bidirectional") {
+                    if (depart >= 0) {
+                        throw invalid_argument("Bidirectional search does not support depart");
+                    }
+                    result = trace == "none" ? getBidirectionalRoute(campusGraph, start, end, profile)
+                                             : getBidirectionalPath(campusGraph, start, end, profile);
+                }
+                else if (table) {
+                    result = getTableRoute(campusGraph, *table, start, end);
+                }
+                else {
+                    result = trace == "none" ? getDijkstraRoute(campusGraph, start, end, depart, profile, astar, landmarks.get())
+                                             : getDijkstraPath(campusGraph, start, end, depart, profile, astar, landmarks.get());
+                }
+                // A request pinned to an older version would add an entry nothing can hit.
+                // The stored copy says "cached" instead of replaying this search's time.
+                if (cacheable && campusGraph.getVersion() >= store.snapshot()->getVersion()) {
+                    json stored = result;
+                    stored.erase("searchMicros");
+                    stored["cached"] = true;
+                    routeCache->put(cacheKey, make_shared<const string>(stored.dump()));
+                }
+                sendResponse(clientSocket, result.dump());
+            }
+        }
+        
+        // GET /api/partition - Cells of a partitioned campus with their sizes and cut;
+        // ?cell=3 lists the nodes and boundary nodes of one cell
+        else if (path == "/api/partition") {
+            json result = params.count("cell") ? cellToJSON(campusGraph, stoi(params["cell"])) : partitionToJSON(campusGraph);
             sendResponse(clientSocket, result.dump());
         }
         
@@ -104,7 +460,10 @@ void handleRequest(int clientSocket, const string& request) {
         
         // GET /api/sort?reference=0
         else if (path == "/api/sort") {
-            int reference = stoi(params["reference"]);
+            int reference = campusGraph.toInternal(stoi(params["reference"]));
+            if (reference < 0) {
+                throw invalid_argument("Unknown location");
+            }
             
             json result = sortLocationsByDistance(campusGraph, reference);
             sendResponse(clientSocket, result.dump());
@@ -116,13 +475,142 @@ void handleRequest(int clientSocket, const string& request) {
         }
     }
     catch (const exception& e) {
+        failed = true;
         json error;
         error["error"] = e.what();
         sendResponse(clientSocket, error.dump());
     }
+    
+    if (handle.campus) {
+        auto elapsed = chrono::steady_clock::now() - startTime;
+        handle.campus->metrics.record(chrono::duration_cast<chrono::microseconds>(elapsed).count(), failed);
+    }
 }
 
-int main() {
+// Save a generated or imported graph, with its contraction hierarchy and landmark tables if asked for
+void saveSnapshot(const Graph& g, const string& path, bool withHierarchy, int landmarkCount) {
+    SnapshotFile file;
+    file.putGraph(g);
+    if (withHierarchy) {
+        auto startTime = chrono::steady_clock::now();
+        ContractionHierarchy ch = buildContractionHierarchy(g);
+        auto elapsed = chrono::duration_cast<chrono::milliseconds>(chrono::steady_clock::now() - startTime);
+        cout << "Contraction hierarchy: " << ch.shortcutCount() << " shortcuts in " << elapsed.count() << " ms" << endl;
+        file.setSection("CHGR", ch.toSection());
+    }
+    if (landmarkCount > 0) {
+        auto startTime = chrono::steady_clock::now();
+        LandmarkTables tables = LandmarkTables::build(g, landmarkCount);
+        auto elapsed = chrono::duration_cast<chrono::milliseconds>(chrono::steady_clock::now() - startTime);
+        cout << "Landmarks: " << tables.getCount() << " in " << elapsed.count() << " ms" << endl;
+        file.setSection("LMRK", tables.toSection());
+    }
+    file.save(path);
+}
+
+int main(int argc, char* argv[]) {
+    int port = 8080;
+    string snapshotDir = "snapshots";
+    size_t memoryBudgetMB = 1024;
+    unsigned threads = thread::hardware_concurrency();
+    buildThreads = max(1u, thread::hardware_concurrency() / 4);
+    bool compressAdjacency = false;
+    bool buildHierarchy = false;
+    string nodeOrder = "none";
+    int cellSize = 0;
+    int landmarkCount = 0;
+    int allPairsLimit = 0;
+    size_t routeCacheMB = 64;
+    string generateKind, importPath, outputPath;
+    int generateNodes = 1000;
+    uint64_t seed = 42;
+    
+    for (int i = 1; i < argc; i += 2) {
+        string flag = argv[i];
+        if (flag == "--compress-adjacency") {
+            compressAdjacency = true;
+            i--;  // takes no value
+        }
+        else if (flag == "--ch") {
+            buildHierarchy = true;
+            i--;
+        }
+        else if (i + 1 >= argc) {
+            cerr << "Missing value for " << flag << endl;
+            return 1;
+        }
+        else if (flag == "--port") port = stoi(argv[i + 1]);
+        else if (flag == "--snapshots") snapshotDir = argv[i + 1];
+        else if (flag == "--memory-mb") memoryBudgetMB = stoul(argv[i + 1]);
+        else if (flag == "--threads") threads = stoul(argv[i + 1]);
+        else if (flag == "--build-threads") buildThreads = max(1ul, stoul(argv[i + 1]));
+        else if (flag == "--reorder") nodeOrder = argv[i + 1];
+        else if (flag == "--partition") cellSize = stoi(argv[i + 1]);
+        else if (flag == "--landmarks") landmarkCount = stoi(argv[i + 1]);
+        else if (flag == "--all-pairs") allPairsLimit = stoi(argv[i + 1]);
+        else if (flag == "--route-cache-mb") routeCacheMB = stoul(argv[i + 1]);
+        else if (flag == "--generate") generateKind = argv[i + 1];
+        else if (flag == "--nodes") generateNodes = stoi(argv[i + 1]);
+        else if (flag == "--seed") seed = stoull(argv[i + 1]);
+        else if (flag == "--import-osm") importPath = argv[i + 1];
+        else if (flag == "--out") outputPath = argv[i + 1];
+        else {
+            cerr << "Unknown option " << flag << endl;
+            return 1;
+        }
+    }
+    
+    // Convert an OSM XML extract to a snapshot instead of serving:
+    //   campus_server --import-osm campus.osm --out snapshots/campus.cgs [--reorder hilbert] [--partition 1000] [--ch] [--landmarks 8]
+    if (!importPath.empty()) {
+        try {
+            if (outputPath.empty()) outputPath = snapshotDir + "/imported.cgs";
+            auto startTime = chrono::steady_clock::now();
+            Graph g = importOsm(importPath);
+            reorderGraph(g, nodeOrder);
+            if (cellSize > 0) g.setCells(partitionGraph(g, cellSize));
+            saveSnapshot(g, outputPath, buildHierarchy, landmarkCount);
+            auto elapsed = chrono::duration_cast<chrono::milliseconds>(chrono::steady_clock::now() - startTime);
+            cout << "Imported " << importPath << ": " << g.size() << " nodes, "
+                 << g.getEdges().size() << " edges in " << elapsed.count() << " ms -> " << outputPath << endl;
+            if (g.hasCells()) cout << "Partitioned into " << g.getCellCount() << " cells, " << g.getCutSize() << " cut edges" << endl;
+            return 0;
+        }
+        catch (const exception& e) {
+            cerr << "Import failed: " << e.what() << endl;
+            return 1;
+        }
+    }
+    
+    // Generate a synthetic graph snapshot instead of serving:
+    //   campus_server --generate grid|geometric|clustered --nodes 100000 --seed 42 [--out file.cgs] [--partition 1000] [--ch] [--landmarks 8]
+    if (!generateKind.empty()) {
+        try {
+            if (outputPath.empty()) outputPath = snapshotDir + "/" + generateKind + ".cgs";
+            auto startTime = chrono::steady_clock::now();
+            Graph g = generateGraph(generateKind, generateNodes, seed);
+            reorderGraph(g, nodeOrder);
+            if (cellSize > 0) g.setCells(partitionGraph(g, cellSize));
+            saveSnapshot(g, outputPath, buildHierarchy, landmarkCount);
+            auto elapsed = chrono::duration_cast<chrono::milliseconds>(chrono::steady_clock::now() - startTime);
+            cout << "Generated " << generateKind << " graph: " << g.size() << " nodes, "
+                 << g.getEdges().size() << " edges in " << elapsed.count() << " ms -> " << outputPath << endl;
+            if (g.hasCells()) cout << "Partitioned into " << g.getCellCount() << " cells, " << g.getCutSize() << " cut edges" << endl;
+            return 0;
+        }
+        catch (const exception& e) {
+            cerr << "Generation failed: " << e.what() << endl;
+            return 1;
+        }
+    }
+    
+    registry.reset(new CampusRegistry(snapshotDir, memoryBudgetMB * 1024 * 1024, compressAdjacency, nodeOrder, landmarkCount,
+                                      allPairsLimit));
+    registry->addBuiltin(defaultCampus, createCampusGraph());
+    routeCache.reset(new RouteCache(routeCacheMB * 1024 * 1024));
+    pool.reset(new ThreadPool(threads));
+    background.reset(new ThreadPool(1));
+    
     // Initialize Winsock
     WSADATA wsaData;
     if (WSAStartup(MAKEWORD(2, 2), &wsaData) != 0) {
@@ -145,7 +633,7 @@ int main() {
     sockaddr_in serverAddr;
     serverAddr.sin_family = AF_INET;
     serverAddr.sin_addr.s_addr = INADDR_ANY;
-    serverAddr.sin_port = htons(8080);
+    serverAddr.sin_port = htons(port);
     
     if (bind(serverSocket, (sockaddr*)&serverAddr, sizeof(serverAddr)) == SOCKET_ERROR) {
         cerr << "Error binding socket: " << WSAGetLastError() << endl;
@@ -164,12 +652,33 @@ int main() {
     cout << "========================================" << endl;
     cout << "Campus Navigator Server" << endl;
     cout << "========================================" << endl;
-    cout << "Server running on http://localhost:8080" << endl;
+    cout << "Server running on http://localhost:" << port << endl;
+    cout << "Snapshots: " << snapshotDir << "/<campus>.cgs, budget " << memoryBudgetMB
+         << " MB, " << pool->threadCount() << " worker threads, " << buildThreads << " for rebuilds" << endl;
     cout << "Endpoints:" << endl;
     cout << "  GET /api/graph" << endl;
+    cout << "  GET /api/graph?bbox=0,0,500,400&zoom=1" << endl;
+    cout << "  GET /api/graph?since=3" << endl;
+    cout << "  GET /api/tile?z=1&x=0&y=1" << endl;
     cout << "  GET /api/dijkstra?start=0&end=9" << endl;
+    cout << "  GET /api/dijkstra?from=Library&to=Hostel" << endl;
+    cout << "  GET /api/dijkstra?start=0&end=9&depart=08:30" << endl;
+    cout << "  GET /api/dijkstra?start=0&end=9&profile=wheelchair" << endl;
+    cout << "  GET /api/dijkstra?start=0&end=9&trace=none" << endl;
+    cout << "  GET /api/astar?start=0&end=9" << endl;
+    cout << "  GET /api/dijkstra?start=0&end=9&algorithm=bidirectional" << endl;
+    cout << "  GET /api/dijkstra?start=0&end=9&algorithm=ch" << endl;
+    cout << "  GET /api/dijkstra?start=0&end=9&algorithm=alt" << endl;
+    cout << "  GET /api/partition?cell=0" << endl;
     cout << "  GET /api/search?query=Library" << endl;
     cout << "  GET /api/sort?reference=0" << endl;
+    cout << "  GET /api/nearest?x=400&y=300&k=3" << endl;
+    cout << "  GET /api/nodes?bbox=0,0,500,400" << endl;
+    cout << "  POST /api/edges" << endl;
+    cout << "  POST /api/matrix" << endl;
+    cout << "  GET /api/metrics" << endl;
+    cout << "  GET /api/campuses" << endl;
+    cout << "  (prefix any route with /api/{campus}/ for other campuses)" << endl;
     cout << "========================================" << endl;
     
     while (true) {
@@ -183,15 +692,15 @@ int main() {
             continue;
         }
         
-        char buffer[4096] = {0};
-        int bytesRead = recv(clientSocket, buffer, sizeof(buffer) - 1, 0);
-        
-        if (bytesRead > 0) {
-            string request(buffer);
-            handleRequest(clientSocket, request);
-        }
-        
-        closesocket(clientSocket);
+        pool->submit([clientSocket]() {
+            string request = receiveRequest(clientSocket);
+            
+            if (!request.empty()) {
+                handleRequest(clientSocket, request);
+            }
+            
+            closesocket(clientSocket);
+        });
     }
     
     closesocket(serverSocket);
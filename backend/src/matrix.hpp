@@ -0,0 +1,142 @@
+#pragma once
+#include "graph.hpp"
+#include "ch.hpp"
+#include "parallel.hpp"
+#include "workspace.hpp"
+#include "routing_profile.hpp"
+#include "../lib/json.hpp"
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <algorithm>
+#include <stdexcept>
+
+using json = nlohmann::json;
+using namespace std;
+
+// Costs between every source and every target, row-major (values[i * columns + j]
+// for source i and target j), -1 where no route exists. The cost is what the
+// routing profile minimises: meters for walking.
+struct DistanceMatrix {
+    int rows = 0, columns = 0;
+    vector<int32_t> values;
+    string method;  // "ch-buckets" or "dijkstra"
+};
+
+const size_t maxMatrixCells = 4000000;
+
+// One Dijkstra per source, stopping once every reachable target is settled.
+// Labels live in the calling thread's workspace, targets marked by their flag.
+void matrixRowByDijkstra(const Graph& g, int source, const vector<int>& targets, int routingProfile, int32_t* row) {
+    const int* profileCost = g.routingWeights(routingProfile);
+    SearchWorkspace& labels = searchWorkspace(g.size());
+    IndexedHeap<4>& frontier = searchFrontier<IndexedHeap<4>>(g.size());
+    int remaining = 0;
+    for (int t : targets) {
+        if (g.connected(source, t) && !labels[t].flag) {
+            labels[t].flag = 1;
+            remaining++;
+        }
+    }
+
+    labels[source].dist = 0;
+    frontier.push(source, 0);
+    while (!frontier.empty() && remaining > 0) {
+        int u = frontier.pop();
+        const SearchWorkspace::Label& label = labels[u];
+        int d = label.dist;
+        remaining -= label.flag;
+        int slot = g.rowOffset(u);
+        for (const Neighbor& nb : g.neighbors(u)) {
+            int cost = profileCost ? profileCost[slot] : nb.weight;
+            slot++;
+            if (cost == INF) continue;
+            SearchWorkspace::Label& next = labels[nb.to];
+            if (d + cost >= next.dist) continue;
+            next.dist = d + cost;
+            frontier.push(nb.to, next.dist);
+        }
+    }
+    for (size_t j = 0; j < targets.size(); j++) row[j] = labels.dist(targets[j]) == INF ? -1 : labels.dist(targets[j]);
+}
+
+// Bucket-based many-to-many on a contraction hierarchy: the upward search space
+// of each target leaves (target, distance) in a bucket at every node it settles;
+// the upward search of each source then scans the buckets of the nodes it
+// settles. Every shortest path has a highest node both searches reach.
+void matrixByBuckets(const ContractionHierarchy& ch, const vector<int>& sources, const vector<int>& targets,
+                     DistanceMatrix& matrix, unsigned threads) {
+    struct BucketEntry {
+        int node, target, dist;
+    };
+    vector<vector<pair<int, int>>> spaces(targets.size());
+    parallelFor(targets.size(), [&](size_t j, unsigned) { spaces[j] = ch.upwardSearch(targets[j]); }, threads);
+
+    // Buckets as one array sorted by node, with an offset per node
+    vector<BucketEntry> entries;
+    for (size_t j = 0; j < targets.size(); j++) {
+        for (const auto& settled : spaces[j]) entries.push_back({settled.first, (int)j, settled.second});
+        vector<pair<int, int>>().swap(spaces[j]);
+    }
+    vector<int> bucketOffset(ch.size() + 1, 0);
+    for (const auto& e : entries) bucketOffset[e.node + 1]++;
+    for (int v = 0; v < ch.size(); v++) bucketOffset[v + 1] += bucketOffset[v];
+    vector<pair<int, int>> buckets(entries.size());
+    vector<int> fill(bucketOffset.begin(), bucketOffset.end() - 1);
+    for (const auto& e : entries) buckets[fill[e.node]++] = {e.target, e.dist};
+    vector<BucketEntry>().swap(entries);
+
+    parallelFor(sources.size(), [&](size_t i, unsigned) {
+        vector<int> best(targets.size(), INF);
+        for (const auto& settled : ch.upwardSearch(sources[i])) {
+            int v = settled.first;
+            for (int k = bucketOffset[v]; k < bucketOffset[v + 1]; k++) {
+                best[buckets[k].first] = min(best[buckets[k].first], settled.second + buckets[k].second);
+            }
+        }
+        int32_t* row = &matrix.values[i * targets.size()];
+        for (size_t j = 0; j < targets.size(); j++) row[j] = best[j] == INF ? -1 : best[j];
+    }, threads);
+}
+
+// The hierarchy is used when given (it covers walking costs only); otherwise one
+// search per source. Sources are spread over `threads` threads either way.
+DistanceMatrix computeMatrix(const Graph& g, const ContractionHierarchy* ch, const vector<int>& sources,
+                             const vector<int>& targets, int routingProfile, unsigned threads = 0) {
+    if (sources.empty() || targets.empty()) throw invalid_argument("Matrix needs at least one source and one target");
+    if (sources.size() * targets.size() > maxMatrixCells) throw invalid_argument("Matrix is too large");
+
+    DistanceMatrix matrix;
+    matrix.rows = sources.size();
+    matrix.columns = targets.size();
+    matrix.values.assign(sources.size() * targets.size(), -1);
+    if (ch && routingProfile == 0 && ch->getVersion() == g.getVersion()) {
+        matrix.method = "ch-buckets";
+        matrixByBuckets(*ch, sources, targets, matrix, threads);
+        return matrix;
+    }
+
+    matrix.method = "dijkstra";
+    parallelFor(sources.size(), [&](size_t i, unsigned) {
+        matrixRowByDijkstra(g, sources[i], targets, routingProfile, &matrix.values[i * targets.size()]);
+    }, threads);
+    return matrix;
+}
+
+json matrixToJSON(const Graph& g, const DistanceMatrix& matrix, const vector<int>& sources, const vector<int>& targets,
+                  int routingProfile) {
+    json result;
+    result["profile"] = routingProfiles()[routingProfile].name;
+    result["method"] = matrix.method;
+    result["rows"] = matrix.rows;
+    result["columns"] = matrix.columns;
+    result["sources"] = toExternalIds(g, sources);
+    result["targets"] = toExternalIds(g, targets);
+    result["values"] = matrix.values;
+    return result;
+}
+
+// Raw little-endian int32 values, row-major
+string matrixToBinary(const DistanceMatrix& matrix) {
+    return string(reinterpret_cast<const char*>(matrix.values.data()), matrix.values.size() * sizeof(int32_t));
+}
@@ -0,0 +1,192 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cctype>
+#include <algorithm>
+
+using namespace std;
+
+// Lowercase a name and collapse runs of whitespace, so "main  GATE " matches "Main Gate"
+string normalizeName(const string& name) {
+    string normalized;
+    normalized.reserve(name.size());
+    bool pendingSpace = false;
+    for (char c : name) {
+        if (isspace(static_cast<unsigned char>(c))) {
+            pendingSpace = !normalized.empty();
+            continue;
+        }
+        if (pendingSpace) {
+            normalized += ' ';
+            pendingSpace = false;
+        }
+        normalized += static_cast<char>(tolower(static_cast<unsigned char>(c)));
+    }
+    return normalized;
+}
+
+// FNV-1a over the bytes of a string
+uint64_t hashName(const string& key) {
+    uint64_t h = 1469598103934665603ULL;
+    for (char c : key) {
+        h ^= static_cast<unsigned char>(c);
+        h *= 1099511628211ULL;
+    }
+    return h;
+}
+
+// Finalizer used to derive independent hashes from one FNV value
+uint64_t mixHash(uint64_t h) {
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ULL;
+    h ^= h >> 33;
+    return h;
+}
+
+// Name -> node id index over normalized names.
+// build() makes an open-addressing table (linear probing, load <= 1/2).
+// buildPerfect() makes a minimal perfect hash (hash-and-displace) for graphs that
+// never change after load: every key lands in its own slot, so a lookup is one
+// probe plus one string compare.
+class NameIndex {
+private:
+    struct Slot {
+        uint64_t hash;
+        int id;  // -1 = empty
+    };
+
+    vector<Slot> slots;
+    vector<string> keys;  // normalized key of each slot
+    vector<uint32_t> seeds;  // per-bucket displacement (perfect mode only)
+    bool perfect = false;
+
+    static uint64_t slotHash(uint64_t h, uint32_t seed) {
+        return mixHash(h ^ (seed * 0x9e3779b97f4a7c15ULL));
+    }
+
+    // Drop duplicate keys, keeping the last id (same as repeated map assignment)
+    static void dedupe(vector<pair<string, int>>& entries) {
+        stable_sort(entries.begin(), entries.end(),
+                    [](const pair<string, int>& a, const pair<string, int>& b) { return a.first < b.first; });
+        vector<pair<string, int>> unique;
+        for (size_t i = 0; i < entries.size(); i++) {
+            if (i + 1 < entries.size() && entries[i + 1].first == entries[i].first) continue;
+            unique.push_back(entries[i]);
+        }
+        entries.swap(unique);
+    }
+
+public:
+    void build(const vector<string>& names) {
+        perfect = false;
+        seeds.clear();
+
+        size_t capacity = 4;
+        while (capacity < names.size() * 2) capacity *= 2;
+        slots.assign(capacity, {0, -1});
+        keys.assign(capacity, "");
+
+        for (size_t id = 0; id < names.size(); id++) {
+            string key = normalizeName(names[id]);
+            uint64_t h = hashName(key);
+            size_t mask = capacity - 1;
+            for (size_t i = h & mask; ; i = (i + 1) & mask) {
+                if (slots[i].id == -1 || (slots[i].hash == h && keys[i] == key)) {
+                    slots[i] = {h, (int)id};
+                    keys[i] = key;
+                    break;
+                }
+            }
+        }
+    }
+
+    void buildPerfect(const vector<string>& names) {
+        vector<pair<string, int>> entries;
+        for (size_t id = 0; id < names.size(); id++) {
+            entries.push_back({normalizeName(names[id]), (int)id});
+        }
+        dedupe(entries);
+
+        size_t n = max<size_t>(entries.size(), 1);
+        size_t bucketCount = max<size_t>(n / 4, 1);
+        vector<vector<int>> buckets(bucketCount);
+        vector<uint64_t> hashes(entries.size());
+        for (size_t i = 0; i < entries.size(); i++) {
+            hashes[i] = hashName(entries[i].first);
+            buckets[mixHash(hashes[i]) % bucketCount].push_back(i);
+        }
+
+        // Place the largest buckets first while the table is still empty
+        vector<int> order(bucketCount);
+        for (size_t b = 0; b < bucketCount; b++) order[b] = b;
+        sort(order.begin(), order.end(), [&](int a, int b) {
+            return buckets[a].size() > buckets[b].size();
+        });
+
+        slots.assign(n, {0, -1});
+        keys.assign(n, "");
+        seeds.assign(bucketCount, 0);
+        vector<size_t> targets;
+        for (int b : order) {
+            if (buckets[b].empty()) continue;
+            for (uint32_t seed = 1; ; seed++) {
+                targets.clear();
+                bool fits = true;
+                for (int i : buckets[b]) {
+                    size_t t = slotHash(hashes[i], seed) % n;
+                    if (slots[t].id != -1 || std::find(targets.begin(), targets.end(), t) != targets.end()) {
+                        fits = false;
+                        break;
+                    }
+                    targets.push_back(t);
+                }
+                if (!fits) continue;
+
+                seeds[b] = seed;
+                for (size_t k = 0; k < buckets[b].size(); k++) {
+                    int i = buckets[b][k];
+                    slots[targets[k]] = {hashes[i], entries[i].second};
+                    keys[targets[k]] = entries[i].first;
+                }
+                break;
+            }
+        }
+        perfect = true;
+    }
+
+    // Node id for a name in any casing/spacing, or -1
+    int find(const string& name) const {
+        if (slots.empty()) return -1;
+        string key = normalizeName(name);
+        uint64_t h = hashName(key);
+
+        if (perfect) {
+            size_t b = mixHash(h) % seeds.size();
+            size_t t = slotHash(h, seeds[b]) % slots.size();
+            return (slots[t].id != -1 && slots[t].hash == h && keys[t] == key) ? slots[t].id : -1;
+        }
+
+        size_t mask = slots.size() - 1;
+        for (size_t i = h & mask; slots[i].id != -1; i = (i + 1) & mask) {
+            if (slots[i].hash == h && keys[i] == key) return slots[i].id;
+        }
+        return -1;
+    }
+
+    // Approximate heap bytes held by the index
+    size_t memoryUsage() const {
+        size_t bytes = slots.capacity() * sizeof(Slot) + keys.capacity() * sizeof(string)
+                     + seeds.capacity() * sizeof(uint32_t);
+        for (const auto& k : keys) {
+            if (k.capacity() > 15) bytes += k.capacity() + 1;  // beyond the small-string buffer
+        }
+        return bytes;
+    }
+
+    bool isPerfect() const {
+        return perfect;
+    }
+};
@@ -0,0 +1,348 @@
+#pragma once
+#include "graph.hpp"
+#include "routing_profile.hpp"
+#include <istream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <map>
+#include <cmath>
+#include <cstdint>
+#include <cctype>
+#include <cstdlib>
+#include <stdexcept>
+
+using namespace std;
+
+// One XML tag as read from the stream: <name a="1" b="2">, </name> or <name/>
+struct XmlTag {
+    string name;
+    vector<pair<string, string>> attributes;
+    bool closing = false;      // </name>
+    bool selfClosing = false;  // <name ... />
+
+    const string* attribute(const string& key) const {
+        for (const auto& a : attributes) {
+            if (a.first == key) return &a.second;
+        }
+        return nullptr;
+    }
+};
+
+// Minimal streaming tag reader for OSM XML. Only tags and their attributes are
+// returned (OSM keeps all data in attributes); text, comments and declarations
+// are skipped. The buffer holds at most one chunk plus one partial tag.
+class XmlTagReader {
+private:
+    istream& in;
+    string buffer;
+    size_t position = 0;
+    static const size_t chunkSize = 1 << 20;
+
+    bool refill() {
+        buffer.erase(0, position);
+        position = 0;
+        size_t oldSize = buffer.size();
+        buffer.resize(oldSize + chunkSize);
+        in.read(&buffer[oldSize], chunkSize);
+        buffer.resize(oldSize + in.gcount());
+        return in.gcount() > 0;
+    }
+
+    static string decodeEntities(const string& text) {
+        if (text.find('&') == string::npos) return text;
+        string out;
+        for (size_t i = 0; i < text.size(); i++) {
+            if (text[i] == '&') {
+                size_t end = text.find(';', i);
+                if (end != string::npos) {
+                    string entity = text.substr(i + 1, end - i - 1);
+                    if (entity == "amp") { out += '&'; i = end; continue; }
+                    if (entity == "lt") { out += '<'; i = end; continue; }
+                    if (entity == "gt") { out += '>'; i = end; continue; }
+                    if (entity == "quot") { out += '"'; i = end; continue; }
+                    if (entity == "apos") { out += '\''; i = end; continue; }
+                }
+            }
+            out += text[i];
+        }
+        return out;
+    }
+
+    void parseTag(size_t start, size_t end, XmlTag& tag) {
+        tag.attributes.clear();
+        tag.closing = buffer[start + 1] == '/';
+        tag.selfClosing = buffer[end - 1] == '/';
+
+        size_t i = start + (tag.closing ? 2 : 1);
+        size_t nameStart = i;
+        while (i < end && !isspace(static_cast<unsigned char>(buffer[i])) && buffer[i] != '/' && buffer[i] != '>') i++;
+        tag.name.assign(buffer, nameStart, i - nameStart);
+
+        while (i < end) {
+            while (i < end && (isspace(static_cast<unsigned char>(buffer[i])) || buffer[i] == '/')) i++;
+            size_t keyStart = i;
+            while (i < end && buffer[i] != '=' && !isspace(static_cast<unsigned char>(buffer[i])) && buffer[i] != '>') i++;
+            if (i >= end || buffer[i] != '=') break;
+            string key = buffer.substr(keyStart, i - keyStart);
+            i++;
+            if (i >= end) break;
+            char quote = buffer[i];
+            if (quote != '"' && quote != '\'') break;
+            size_t valueEnd = buffer.find(quote, i + 1);
+            if (valueEnd == string::npos || valueEnd > end) break;
+            tag.attributes.push_back({key, decodeEntities(buffer.substr(i + 1, valueEnd - i - 1))});
+            i = valueEnd + 1;
+        }
+    }
+
+public:
+    XmlTagReader(istream& input) : in(input) {}
+
+    bool next(XmlTag& tag) {
+        while (true) {
+            size_t start = buffer.find('<', position);
+            if (start == string::npos) {
+                position = buffer.size();
+                if (!refill()) return false;
+                continue;
+            }
+
+            // Find the closing '>' outside quoted attribute values
+            size_t end = string::npos;
+            char quote = 0;
+            for (size_t i = start + 1; i < buffer.size(); i++) {
+                char c = buffer[i];
+                if (quote) { if (c == quote) quote = 0; }
+                else if (c == '"' || c == '\'') quote = c;
+                else if (c == '>') { end = i; break; }
+            }
+            if (end == string::npos) {
+                position = start;
+                if (!refill()) return false;
+                continue;
+            }
+
+            position = end + 1;
+            char kind = buffer[start + 1];
+            if (kind == '?' || kind == '!') continue;  // declaration or comment
+
+            parseTag(start, end, tag);
+            return true;
+        }
+    }
+};
+
+// Imports the walkable network of an OSM XML extract in two streaming passes:
+//   1. keep ways whose highway tag is walkable, remembering only their node refs
+//   2. read coordinates (and names) of just the referenced nodes
+// Way endpoints and nodes shared by several ways become graph nodes; the shape
+// points in between only contribute to the edge length. Memory grows with the
+// footpath network, not with the size of the extract.
+class OsmImporter {
+private:
+    struct Way {
+        vector<int64_t> refs;
+        string pathType;
+        uint8_t attributes;
+    };
+
+    struct Point {
+        double lat = 0, lon = 0;
+        bool seen = false;
+        string name;
+        string type;
+    };
+
+    vector<Way> ways;
+    unordered_map<int64_t, int> refUse;  // OSM node id -> number of way references
+    unordered_map<int64_t, Point> points;
+
+    // highway=* value -> our pathType, empty if the way is not walkable
+    static string walkablePathType(const string& highway) {
+        if (highway == "footway" || highway == "pedestrian" || highway == "path") return "walkway";
+        if (highway == "steps") return "stairs";
+        return "";
+    }
+
+    // Edge attribute bits from the way's tags
+    static uint8_t wayAttributes(const string& pathType, const map<string, string>& tags) {
+        uint8_t attributes = defaultEdgeAttributes(pathType);
+        auto value = [&](const string& key) {
+            auto it = tags.find(key);
+            return it == tags.end() ? string() : it->second;
+        };
+        if (value("covered") == "yes" || value("tunnel") == "yes" || value("indoor") == "yes") attributes |= EDGE_COVERED;
+        if (value("lit") == "yes") attributes |= EDGE_LIT;
+        if (value("wheelchair") == "no") attributes &= ~EDGE_ACCESSIBLE;
+        if (value("wheelchair") == "yes") attributes |= EDGE_ACCESSIBLE;
+        string incline = value("incline");
+        if (!incline.empty() && incline != "0" && incline != "0%" && incline != "no") attributes |= EDGE_SLOPE;
+        return attributes;
+    }
+
+    static double haversineMeters(double lat1, double lon1, double lat2, double lon2) {
+        const double R = 6371000.0, toRad = 3.14159265358979 / 180.0;
+        double dLat = (lat2 - lat1) * toRad, dLon = (lon2 - lon1) * toRad;
+        double a = sin(dLat / 2) * sin(dLat / 2) +
+                   cos(lat1 * toRad) * cos(lat2 * toRad) * sin(dLon / 2) * sin(dLon / 2);
+        return 2 * R * atan2(sqrt(a), sqrt(1 - a));
+    }
+
+    void readWays(istream& in) {
+        XmlTagReader reader(in);
+        XmlTag tag;
+        bool inWay = false;
+        Way current;
+        map<string, string> tags;
+
+        while (reader.next(tag)) {
+            if (tag.name == "way" && !tag.closing) {
+                inWay = !tag.selfClosing;
+                current.refs.clear();
+                tags.clear();
+            }
+            else if (inWay && tag.name == "nd") {
+                if (const string* ref = tag.attribute("ref")) current.refs.push_back(strtoll(ref->c_str(), nullptr, 10));
+            }
+            else if (inWay && tag.name == "tag") {
+                const string* k = tag.attribute("k");
+                const string* v = tag.attribute("v");
+                if (k && v) tags[*k] = *v;
+            }
+            else if (tag.name == "way" && tag.closing) {
+                inWay = false;
+                string pathType = walkablePathType(tags["highway"]);
+                if (pathType.empty() || tags["area"] == "yes" || current.refs.size() < 2) continue;
+
+                for (size_t i = 0; i < current.refs.size(); i++) {
+                    // Endpoints count twice so they always become graph nodes
+                    bool endpoint = i == 0 || i + 1 == current.refs.size();
+                    refUse[current.refs[i]] += endpoint ? 2 : 1;
+                }
+                current.pathType = pathType;
+                current.attributes = wayAttributes(pathType, tags);
+                ways.push_back(current);
+            }
+        }
+    }
+
+    void readNodes(istream& in) {
+        for (const auto& use : refUse) points[use.first];
+
+        XmlTagReader reader(in);
+        XmlTag tag;
+        Point* current = nullptr;
+
+        while (reader.next(tag)) {
+            if (tag.name == "node" && !tag.closing) {
+                current = nullptr;
+                const string* id = tag.attribute("id");
+                if (!id) continue;
+                auto it = points.find(strtoll(id->c_str(), nullptr, 10));
+                if (it == points.end()) continue;
+
+                const string* lat = tag.attribute("lat");
+                const string* lon = tag.attribute("lon");
+                if (!lat || !lon) continue;
+                it->second.lat = strtod(lat->c_str(), nullptr);
+                it->second.lon = strtod(lon->c_str(), nullptr);
+                it->second.seen = true;
+                if (!tag.selfClosing) current = &it->second;
+            }
+            else if (current && tag.name == "tag") {
+                const string* k = tag.attribute("k");
+                const string* v = tag.attribute("v");
+                if (k && v && *k == "name") current->name = *v;
+                if (k && v && (*k == "amenity" || *k == "building") && current->type.empty()) current->type = *v;
+            }
+            else if (tag.name == "node" && tag.closing) {
+                current = nullptr;
+            }
+            else if (tag.name == "way" || tag.name == "relation") {
+                break;  // OSM files list all nodes before ways
+            }
+        }
+    }
+
+    Graph buildGraph() {
+        // Local equirectangular projection in meters around the centre of the data, y pointing down
+        double minLat = 90, maxLat = -90, minLon = 180, maxLon = -180;
+        for (const auto& p : points) {
+            if (!p.second.seen) continue;
+            minLat = min(minLat, p.second.lat); maxLat = max(maxLat, p.second.lat);
+            minLon = min(minLon, p.second.lon); maxLon = max(maxLon, p.second.lon);
+        }
+        const double metersPerDegree = 6371000.0 * 3.14159265358979 / 180.0;
+        double lonScale = metersPerDegree * cos((minLat + maxLat) / 2 * 3.14159265358979 / 180.0);
+
+        unordered_map<int64_t, int> graphId;
+        Graph g(0);
+        auto junction = [&](int64_t ref) {
+            auto it = graphId.find(ref);
+            if (it != graphId.end()) return it->second;
+            const Point& p = points[ref];
+            int id = g.size();
+            string name = p.name.empty() ? "OSM " + to_string(ref) : p.name;
+            g.addNode(id, name, (p.lon - minLon) * lonScale, (maxLat - p.lat) * metersPerDegree,
+                      p.type.empty() ? "junction" : p.type);
+            graphId[ref] = id;
+            return id;
+        };
+
+        for (const auto& way : ways) {
+            int64_t segmentStart = -1;
+            double length = 0;
+            for (size_t i = 0; i < way.refs.size(); i++) {
+                int64_t ref = way.refs[i];
+                const Point& p = points[ref];
+                if (!p.seen) {  // clipped out of the extract: restart after the gap
+                    segmentStart = -1;
+                    continue;
+                }
+                if (segmentStart != -1) {
+                    const Point& prev = points[way.refs[i - 1]];
+                    if (prev.seen) length += haversineMeters(prev.lat, prev.lon, p.lat, p.lon);
+                }
+                bool isJunction = refUse[ref] >= 2 || i + 1 == way.refs.size();
+                if (segmentStart == -1) {
+                    segmentStart = ref;
+                    length = 0;
+                }
+                else if (isJunction) {
+                    int from = junction(segmentStart);
+                    int to = junction(ref);
+                    if (from != to) {
+                        g.addEdge(from, to, max(1, static_cast<int>(lround(length))), way.pathType);
+                        g.setEdgeAttributes(g.getEdges().size() - 1, way.attributes);
+                    }
+                    segmentStart = ref;
+                    length = 0;
+                }
+            }
+        }
+        g.finalize();
+        return g;
+    }
+
+public:
+    Graph import(const string& path) {
+        if (path.size() > 4 && path.compare(path.size() - 4, 4, ".pbf") == 0) {
+            throw invalid_argument("PBF input is not supported; convert with osmium cat input.pbf -o output.osm");
+        }
+
+        ifstream wayPass(path, ios::binary);
+        if (!wayPass) throw runtime_error("Cannot open " + path);
+        readWays(wayPass);
+
+        ifstream nodePass(path, ios::binary);
+        readNodes(nodePass);
+        return buildGraph();
+    }
+};
+
+Graph importOsm(const string& path) {
+    OsmImporter importer;
+    return importer.import(path);
+}
@@ -0,0 +1,72 @@
+#pragma once
+#include "thread_pool.hpp"
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <memory>
+#include <vector>
+#include <functional>
+#include <condition_variable>
+#include <algorithm>
+
+using namespace std;
+
+// Worker count for CPU-bound preprocessing: all cores unless told otherwise
+unsigned parallelThreads(unsigned requested = 0) {
+    if (requested > 0) return requested;
+    return max(1u, thread::hardware_concurrency());
+}
+
+// Long-lived helper threads for parallelFor. Reusing them keeps each thread's
+// search workspaces (workspace.hpp) from one call to the next, where fresh
+// threads would allocate them at full graph size every time.
+ThreadPool& parallelHelpers() {
+    static ThreadPool helpers(parallelThreads() - 1);
+    return helpers;
+}
+
+// Run body(i, worker) for every i in [0, count) on the calling thread and up to
+// `threads` - 1 helpers. Items are handed out in small chunks from a shared
+// counter, so uneven items balance out, and helpers still busy with another
+// call simply leave more items to the others; `worker` (0 .. threads-1) indexes
+// per-thread scratch space.
+void parallelFor(size_t count, const function<void(size_t, unsigned)>& body, unsigned threads = 0) {
+    threads = min<size_t>(parallelThreads(threads), max<size_t>(count, 1));
+    const size_t chunk = max<size_t>(1, count / (threads * 16));
+
+    // Shared with the helper tasks, which may start after this call has returned;
+    // by then every item is taken, so they never touch body
+    struct State {
+        atomic<size_t> next{0};
+        mutex lock;
+        condition_variable finished;
+        int running = 0;
+    };
+    auto state = make_shared<State>();
+    auto work = [state, count, chunk, &body](unsigned worker) {
+        while (true) {
+            size_t begin = state->next.fetch_add(chunk);
+            if (begin >= count) return;
+            size_t end = min(count, begin + chunk);
+            for (size_t i = begin; i < end; i++) body(i, worker);
+        }
+    };
+
+    for (unsigned w = 1; w < threads; w++) {
+        parallelHelpers().submit([state, work, w]() {
+            {
+                lock_guard<mutex> lock(state->lock);
+                state->running++;
+            }
+            work(w);
+            {
+                lock_guard<mutex> lock(state->lock);
+                state->running--;
+            }
+            state->finished.notify_all();
+        });
+    }
+    work(0);
+    unique_lock<mutex> lock(state->lock);
+    state->finished.wait(lock, [&] { return state->running == 0; });
+}
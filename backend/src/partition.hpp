@@ -0,0 +1,263 @@
+#pragma once
+#include "graph.hpp"
+#include "../lib/json.hpp"
+#include <vector>
+#include <cmath>
+#include <limits>
+#include <algorithm>
+#include <stdexcept>
+
+using json = nlohmann::json;
+using namespace std;
+
+// Balanced partitioning by inertial flow: a cell larger than maxCellSize is
+// sorted along a few directions through the node coordinates; for each one the
+// first and last `balance` fraction of nodes become sources and sinks, and a
+// unit-capacity max flow finds the smallest edge cut between them. The
+// direction with the smallest cut wins and both sides are split further.
+// Every side keeps at least `balance` of its cell's nodes.
+class InertialFlowPartitioner {
+private:
+    const Graph& g;
+    int maxCellSize;
+    double balance;
+    vector<int> edgeOffset, edgeTarget;  // all edges (closed ones too) as undirected CSR
+    vector<int> localIndex;              // node -> position in the cell being split, -1 outside
+    vector<int> cellOf;
+    int cellCount = 0;
+
+    // Residual network of one cell for a unit-capacity max flow. Arcs come in
+    // pairs (a, a ^ 1); an undirected edge is one such pair with capacity 1 each way.
+    struct FlowNetwork {
+        int source, sink;
+        vector<int> head, nextArc, target, capacity;
+        vector<int> level, current;
+
+        FlowNetwork(int nodes) : source(nodes), sink(nodes + 1), head(nodes + 2, -1), level(nodes + 2), current(nodes + 2) {}
+
+        void addPair(int u, int v, int forward, int backward) {
+            target.push_back(v); capacity.push_back(forward); nextArc.push_back(head[u]); head[u] = target.size() - 1;
+            target.push_back(u); capacity.push_back(backward); nextArc.push_back(head[v]); head[v] = target.size() - 1;
+        }
+
+        bool buildLevels() {
+            fill(level.begin(), level.end(), -1);
+            vector<int> queue{source};
+            level[source] = 0;
+            for (size_t i = 0; i < queue.size(); i++) {
+                int u = queue[i];
+                for (int a = head[u]; a >= 0; a = nextArc[a]) {
+                    if (capacity[a] > 0 && level[target[a]] < 0) {
+                        level[target[a]] = level[u] + 1;
+                        queue.push_back(target[a]);
+                    }
+                }
+            }
+            return level[sink] >= 0;
+        }
+
+        // Dinic's algorithm. Every augmenting path crosses a unit edge, so each carries
+        // one unit; the search is iterative to keep long paths off the call stack.
+        // Gives up once the flow reaches `limit` (that cut cannot beat a better one).
+        int maxFlow(int limit) {
+            int flow = 0;
+            vector<int> path;
+            while (flow < limit && buildLevels()) {
+                current = head;
+                int u = source;
+                while (true) {
+                    if (u == sink) {
+                        for (int a : path) {
+                            capacity[a]--;
+                            capacity[a ^ 1]++;
+                        }
+                        path.clear();
+                        u = source;
+                        if (++flow >= limit) break;
+                        continue;
+                    }
+                    int& a = current[u];
+                    while (a >= 0 && (capacity[a] <= 0 || level[target[a]] != level[u] + 1)) a = nextArc[a];
+                    if (a >= 0) {
+                        path.push_back(a);
+                        u = target[a];
+                        continue;
+                    }
+                    if (u == source) break;
+                    level[u] = -1;  // dead end for the rest of this phase
+                    u = target[path.back() ^ 1];
+                    path.pop_back();
+                }
+            }
+            return flow;
+        }
+
+        // Nodes on the source side of the minimum cut: those still reachable from the
+        // source, or those that can no longer reach the sink, whichever is more balanced
+        vector<char> sourceSide(int nodes) {
+            vector<char> fromSource(nodes + 2, 0), toSink(nodes + 2, 0);
+            vector<int> queue{source};
+            fromSource[source] = 1;
+            for (size_t i = 0; i < queue.size(); i++) {
+                for (int a = head[queue[i]]; a >= 0; a = nextArc[a]) {
+                    if (capacity[a] > 0 && !fromSource[target[a]]) {
+                        fromSource[target[a]] = 1;
+                        queue.push_back(target[a]);
+                    }
+                }
+            }
+            queue.assign(1, sink);
+            toSink[sink] = 1;
+            for (size_t i = 0; i < queue.size(); i++) {
+                for (int a = head[queue[i]]; a >= 0; a = nextArc[a]) {
+                    if (capacity[a ^ 1] > 0 && !toSink[target[a]]) {
+                        toSink[target[a]] = 1;
+                        queue.push_back(target[a]);
+                    }
+                }
+            }
+
+            int sourceCount = 0, notSinkCount = 0;
+            for (int i = 0; i < nodes; i++) {
+                sourceCount += fromSource[i];
+                notSinkCount += !toSink[i];
+            }
+            vector<char> side(nodes);
+            bool useSource = abs(2 * sourceCount - nodes) <= abs(2 * notSinkCount - nodes);
+            for (int i = 0; i < nodes; i++) side[i] = useSource ? fromSource[i] : !toSink[i];
+            return side;
+        }
+    };
+
+    void split(vector<int>& cell) {
+        int m = cell.size();
+        if (m <= maxCellSize) {
+            for (int u : cell) cellOf[u] = cellCount;
+            cellCount++;
+            return;
+        }
+
+        // Edges inside the cell, by local position
+        for (int i = 0; i < m; i++) localIndex[cell[i]] = i;
+        vector<pair<int, int>> inner;
+        for (int i = 0; i < m; i++) {
+            for (int k = edgeOffset[cell[i]]; k < edgeOffset[cell[i] + 1]; k++) {
+                int j = localIndex[edgeTarget[k]];
+                if (j > i) inner.push_back({i, j});
+            }
+        }
+        for (int u : cell) localIndex[u] = -1;
+
+        const double pi = 3.14159265358979;
+        int terminals = max(1, static_cast<int>(m * balance));
+        int bestCut = numeric_limits<int>::max();
+        vector<char> bestSide;
+        vector<pair<double, int>> keyed(m);
+        for (int direction = 0; direction < 4; direction++) {
+            double angle = direction * pi / 4;
+            double dx = cos(angle), dy = sin(angle);
+            for (int i = 0; i < m; i++) {
+                const Node& node = g.getNode(cell[i]);
+                keyed[i] = {node.x * dx + node.y * dy, i};
+            }
+            sort(keyed.begin(), keyed.end());
+
+            FlowNetwork network(m);
+            int unbounded = inner.size() + 1;
+            for (const auto& e : inner) network.addPair(e.first, e.second, 1, 1);
+            for (int i = 0; i < terminals; i++) {
+                network.addPair(network.source, keyed[i].second, unbounded, 0);
+                network.addPair(keyed[m - 1 - i].second, network.sink, unbounded, 0);
+            }
+            int cut = network.maxFlow(bestCut);
+            if (cut < bestCut) {
+                bestCut = cut;
+                bestSide = network.sourceSide(m);
+            }
+        }
+
+        vector<int> first, second;
+        for (int i = 0; i < m; i++) (bestSide[i] ? first : second).push_back(cell[i]);
+        vector<int>().swap(cell);
+        split(first);
+        split(second);
+    }
+
+public:
+    InertialFlowPartitioner(const Graph& graph, int maxCell, double terminalFraction = 0.25)
+        : g(graph), maxCellSize(maxCell), balance(terminalFraction) {
+        if (maxCellSize < 1) throw invalid_argument("Cell size must be at least 1");
+        if (balance <= 0 || balance > 0.5) throw invalid_argument("Terminal fraction must be in (0, 0.5]");
+    }
+
+    // Cell of every node, numbered so that cells split from the same parent are adjacent
+    vector<int> run() {
+        int n = g.size();
+        edgeOffset.assign(n + 1, 0);
+        for (const auto& e : g.getEdges()) {
+            if (e.from == e.to) continue;
+            edgeOffset[e.from + 1]++;
+            edgeOffset[e.to + 1]++;
+        }
+        for (int i = 0; i < n; i++) edgeOffset[i + 1] += edgeOffset[i];
+        edgeTarget.resize(edgeOffset[n]);
+        vector<int> fill(edgeOffset.begin(), edgeOffset.end() - 1);
+        for (const auto& e : g.getEdges()) {
+            if (e.from == e.to) continue;
+            edgeTarget[fill[e.from]++] = e.to;
+            edgeTarget[fill[e.to]++] = e.from;
+        }
+
+        localIndex.assign(n, -1);
+        cellOf.assign(n, 0);
+        cellCount = 0;
+        vector<int> all(n);
+        for (int i = 0; i < n; i++) all[i] = i;
+        if (n > 0) split(all);
+        return cellOf;
+    }
+};
+
+// Partition a graph into cells of at most maxCellSize nodes; store the result with Graph::setCells
+vector<int> partitionGraph(const Graph& g, int maxCellSize) {
+    InertialFlowPartitioner partitioner(g, maxCellSize);
+    return partitioner.run();
+}
+
+// Size, cut and boundary of every cell
+json partitionToJSON(const Graph& g) {
+    if (!g.hasCells()) throw invalid_argument("Campus is not partitioned (create snapshots with --partition)");
+
+    vector<int> cellSize(g.getCellCount(), 0);
+    for (int c : g.getCells()) cellSize[c]++;
+
+    json result;
+    result["cellCount"] = g.getCellCount();
+    result["cutEdges"] = g.getCutSize();
+    result["largestCell"] = *max_element(cellSize.begin(), cellSize.end());
+    result["cells"] = json::array();
+    size_t boundaryNodes = 0;
+    for (int c = 0; c < g.getCellCount(); c++) {
+        size_t boundary = g.getCellBoundary(c).size();
+        boundaryNodes += boundary;
+        result["cells"].push_back({{"cell", c}, {"nodes", cellSize[c]}, {"boundaryNodes", boundary}});
+    }
+    result["boundaryNodes"] = boundaryNodes;
+    return result;
+}
+
+// Nodes and boundary nodes of one cell, as external ids
+json cellToJSON(const Graph& g, int cell) {
+    if (!g.hasCells()) throw invalid_argument("Campus is not partitioned (create snapshots with --partition)");
+    if (cell < 0 || cell >= g.getCellCount()) throw invalid_argument("Unknown cell");
+
+    json result;
+    result["cell"] = cell;
+    result["nodes"] = json::array();
+    for (int u = 0; u < g.size(); u++) {
+        if (g.getCell(u) == cell) result["nodes"].push_back(g.toExternal(u));
+    }
+    result["boundary"] = json::array();
+    for (int u : g.getCellBoundary(cell)) result["boundary"].push_back(g.toExternal(u));
+    return result;
+}
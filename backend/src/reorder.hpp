@@ -0,0 +1,100 @@
+#pragma once
+#include "graph.hpp"
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <cstdint>
+#include <stdexcept>
+
+using namespace std;
+
+// Node orders for Graph::renumber. Storing nodes that are close in the graph
+// close in memory keeps Dijkstra's dist/visited/adjacency accesses in cache.
+
+// Position of (x, y) along a Hilbert curve over a 2^16 x 2^16 grid
+uint64_t hilbertIndex(uint32_t x, uint32_t y) {
+    uint64_t d = 0;
+    for (uint32_t s = 1u << 15; s > 0; s >>= 1) {
+        uint32_t rx = (x & s) ? 1 : 0;
+        uint32_t ry = (y & s) ? 1 : 0;
+        d += uint64_t(s) * s * ((3 * rx) ^ ry);
+        if (ry == 0) {  // rotate the quadrant
+            if (rx == 1) {
+                x = s - 1 - x;
+                y = s - 1 - y;
+            }
+            swap(x, y);
+        }
+    }
+    return d;
+}
+
+// Nodes sorted along a Hilbert curve through their coordinates
+vector<int> hilbertOrder(const Graph& g) {
+    int n = g.size();
+    if (n == 0) return {};
+
+    double minX = g.getNode(0).x, maxX = minX, minY = g.getNode(0).y, maxY = minY;
+    for (const auto& node : g.getNodes()) {
+        minX = min(minX, node.x); maxX = max(maxX, node.x);
+        minY = min(minY, node.y); maxY = max(maxY, node.y);
+    }
+    double scale = 65535.0 / max(max(maxX - minX, maxY - minY), 1e-9);
+
+    vector<pair<uint64_t, int>> keyed(n);
+    for (int i = 0; i < n; i++) {
+        const Node& node = g.getNode(i);
+        keyed[i] = {hilbertIndex(uint32_t((node.x - minX) * scale), uint32_t((node.y - minY) * scale)), i};
+    }
+    sort(keyed.begin(), keyed.end());
+
+    vector<int> order(n);
+    for (int i = 0; i < n; i++) order[i] = keyed[i].second;
+    return order;
+}
+
+// Reverse Cuthill-McKee: BFS from a low-degree node of each component, visiting
+// neighbours by increasing degree, then reversed. Needs no coordinates.
+vector<int> rcmOrder(const Graph& g) {
+    int n = g.size();
+    vector<int> byDegree(n);
+    for (int i = 0; i < n; i++) byDegree[i] = i;
+    stable_sort(byDegree.begin(), byDegree.end(), [&](int a, int b) {
+        return g.neighbors(a).size() < g.neighbors(b).size();
+    });
+
+    vector<int> order;
+    order.reserve(n);
+    vector<bool> placed(n, false);
+    vector<int> frontier;
+    for (int root : byDegree) {
+        if (placed[root]) continue;
+        placed[root] = true;
+        size_t head = order.size();
+        order.push_back(root);
+        while (head < order.size()) {
+            int u = order[head++];
+            frontier.clear();
+            for (const auto& nb : g.neighbors(u)) {
+                if (!placed[nb.to]) {
+                    placed[nb.to] = true;
+                    frontier.push_back(nb.to);
+                }
+            }
+            sort(frontier.begin(), frontier.end(), [&](int a, int b) {
+                return g.neighbors(a).size() < g.neighbors(b).size();
+            });
+            order.insert(order.end(), frontier.begin(), frontier.end());
+        }
+    }
+    reverse(order.begin(), order.end());
+    return order;
+}
+
+// Renumber by strategy name: "hilbert", "rcm" or "none"
+void reorderGraph(Graph& g, const string& strategy) {
+    if (strategy == "none" || strategy.empty()) return;
+    if (strategy == "hilbert") g.renumber(hilbertOrder(g));
+    else if (strategy == "rcm") g.renumber(rcmOrder(g));
+    else throw invalid_argument("Unknown node order: " + strategy);
+}
@@ -0,0 +1,123 @@
+#pragma once
+#include "../lib/json.hpp"
+#include <list>
+#include <unordered_map>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <string>
+#include <functional>
+
+using json = nlohmann::json;
+using namespace std;
+
+// Serialized route responses, least recently used first out once the byte
+// capacity is reached. Keys carry the graph version, so an edge change makes
+// every older entry unreachable; invalidate() also frees their space right away.
+// Split into shards with their own lock so concurrent requests rarely contend.
+class RouteCache {
+private:
+    struct Entry {
+        string key;
+        shared_ptr<const string> value;
+        size_t bytes;
+    };
+
+    struct Shard {
+        mutex lock;
+        list<Entry> entries;  // most recently used first
+        unordered_map<string, list<Entry>::iterator> index;
+        size_t bytes = 0;
+    };
+
+    static const size_t shardCount = 16;
+    static const size_t entryOverhead = 96;  // list node, map node and bookkeeping, roughly
+    Shard shards[shardCount];
+    size_t shardCapacity;
+    atomic<uint64_t> hits{0}, misses{0}, evictions{0};
+
+    Shard& shardFor(const string& key) {
+        return shards[hash<string>()(key) % shardCount];
+    }
+
+    // Caller holds the shard lock
+    static void erase(Shard& shard, list<Entry>::iterator it) {
+        shard.bytes -= it->bytes;
+        shard.index.erase(it->key);
+        shard.entries.erase(it);
+    }
+
+public:
+    RouteCache(size_t capacityBytes) : shardCapacity(capacityBytes / shardCount) {}
+
+    // Key of a route query; campus and graph version come first so invalidate() can match them
+    static string key(const string& campus, uint64_t version, const string& query) {
+        return campus + '\n' + to_string(version) + '\n' + query;
+    }
+
+    // Cached response, or null on a miss
+    shared_ptr<const string> get(const string& key) {
+        Shard& shard = shardFor(key);
+        lock_guard<mutex> guard(shard.lock);
+        auto it = shard.index.find(key);
+        if (it == shard.index.end()) {
+            misses++;
+            return nullptr;
+        }
+        hits++;
+        shard.entries.splice(shard.entries.begin(), shard.entries, it->second);
+        return it->second->value;
+    }
+
+    void put(const string& key, shared_ptr<const string> value) {
+        size_t bytes = key.size() + value->size() + entryOverhead;
+        if (bytes > shardCapacity) return;  // would push out everything else
+
+        Shard& shard = shardFor(key);
+        lock_guard<mutex> guard(shard.lock);
+        auto it = shard.index.find(key);
+        if (it != shard.index.end()) erase(shard, it->second);
+        shard.entries.push_front({key, move(value), bytes});
+        shard.index[key] = shard.entries.begin();
+        shard.bytes += bytes;
+        while (shard.bytes > shardCapacity) {
+            erase(shard, prev(shard.entries.end()));
+            evictions++;
+        }
+    }
+
+    // Drop every entry of a campus older than `version`
+    void invalidate(const string& campus, uint64_t version) {
+        string prefix = campus + '\n';
+        for (Shard& shard : shards) {
+            lock_guard<mutex> guard(shard.lock);
+            for (auto it = shard.entries.begin(); it != shard.entries.end();) {
+                auto current = it++;
+                const string& k = current->key;
+                if (k.compare(0, prefix.size(), prefix) != 0) continue;
+                if (stoull(k.substr(prefix.size(), k.find('\n', prefix.size()) - prefix.size())) < version) {
+                    erase(shard, current);
+                }
+            }
+        }
+    }
+
+    json toJSON() {
+        size_t bytes = 0, entries = 0;
+        for (Shard& shard : shards) {
+            lock_guard<mutex> guard(shard.lock);
+            bytes += shard.bytes;
+            entries += shard.entries.size();
+        }
+        uint64_t hitCount = hits.load(), missCount = misses.load();
+        json j;
+        j["capacity"] = shardCapacity * shardCount;
+        j["bytes"] = bytes;
+        j["entries"] = entries;
+        j["hits"] = hitCount;
+        j["misses"] = missCount;
+        j["hitRate"] = hitCount + missCount ? (double)hitCount / (hitCount + missCount) : 0.0;
+        j["evictions"] = evictions.load();
+        return j;
+    }
+};
@@ -0,0 +1,83 @@
+#pragma once
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+using namespace std;
+
+// Edge attribute bits (Edge::attributes)
+const uint8_t EDGE_STAIRS = 1 << 0;
+const uint8_t EDGE_COVERED = 1 << 1;
+const uint8_t EDGE_LIT = 1 << 2;
+const uint8_t EDGE_ACCESSIBLE = 1 << 3;  // step-free with a firm surface
+const uint8_t EDGE_SLOPE = 1 << 4;       // noticeably steep
+const int EDGE_ATTRIBUTE_COUNT = 5;
+
+const char* const EDGE_ATTRIBUTE_NAMES[EDGE_ATTRIBUTE_COUNT] = {"stairs", "covered", "lit", "accessible", "slope"};
+
+// Attributes assumed for edges that were added without any: stairs are stairs,
+// everything else is taken to be step-free
+uint8_t defaultEdgeAttributes(const string& pathType) {
+    return pathType == "stairs" ? EDGE_STAIRS : EDGE_ACCESSIBLE;
+}
+
+uint8_t edgeAttributeBit(const string& name) {
+    for (int i = 0; i < EDGE_ATTRIBUTE_COUNT; i++) {
+        if (name == EDGE_ATTRIBUTE_NAMES[i]) return 1 << i;
+    }
+    throw invalid_argument("Unknown edge attribute: " + name);
+}
+
+vector<string> edgeAttributeNames(uint8_t attributes) {
+    vector<string> names;
+    for (int i = 0; i < EDGE_ATTRIBUTE_COUNT; i++) {
+        if (attributes & (1 << i)) names.push_back(EDGE_ATTRIBUTE_NAMES[i]);
+    }
+    return names;
+}
+
+// How one kind of traveller rates an edge. Edges with a forbidden attribute, or
+// lacking a required one, are unusable; the rest cost weight times the factors
+// of the attributes they have and of those they lack.
+struct RoutingProfile {
+    string name;
+    uint8_t forbidden;
+    uint8_t required;
+    double withFactor[EDGE_ATTRIBUTE_COUNT];
+    double withoutFactor[EDGE_ATTRIBUTE_COUNT];
+
+    // Cost of an edge for this profile, INF if it cannot be used
+    int cost(int weight, uint8_t attributes) const {
+        if ((attributes & forbidden) || (attributes & required) != required) return numeric_limits<int>::max();
+        double factor = 1.0;
+        for (int i = 0; i < EDGE_ATTRIBUTE_COUNT; i++) {
+            factor *= (attributes & (1 << i)) ? withFactor[i] : withoutFactor[i];
+        }
+        return max(1, static_cast<int>(lround(weight * factor)));
+    }
+};
+
+// The profiles every graph compiles weights for; index 0 is plain walking distance
+// and uses the edge weights directly.
+// Factor order: stairs, covered, lit, accessible, slope
+const vector<RoutingProfile>& routingProfiles() {
+    static const vector<RoutingProfile> profiles = {
+        {"walk", 0, 0, {1, 1, 1, 1, 1}, {1, 1, 1, 1, 1}},
+        {"wheelchair", EDGE_STAIRS, EDGE_ACCESSIBLE, {1, 0.9, 1, 1, 2.5}, {1, 1, 1, 1, 1}},
+        {"bike", EDGE_STAIRS, 0, {1, 1, 1, 1, 1.5}, {1, 1, 1, 1, 1}},
+        {"night", 0, 0, {1.2, 1, 1, 1, 1}, {1, 1, 2, 1, 1}},
+    };
+    return profiles;
+}
+
+// Profile index by name, -1 if unknown
+int findRoutingProfile(const string& name) {
+    const auto& profiles = routingProfiles();
+    for (size_t i = 0; i < profiles.size(); i++) {
+        if (profiles[i].name == name) return i;
+    }
+    return -1;
+}
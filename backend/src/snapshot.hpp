@@ -0,0 +1,309 @@
+#pragma once
+#include "graph.hpp"
+#include <string>
+#include <vector>
+#include <map>
+#include <fstream>
+#include <cstring>
+#include <cstdint>
+#include <stdexcept>
+
+using namespace std;
+
+// Append fixed-size values and length-prefixed strings to a byte buffer (little-endian host assumed)
+class ByteWriter {
+private:
+    string bytes;
+
+public:
+    template <typename T>
+    void put(const T& value) {
+        bytes.append(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+
+    template <typename T>
+    void putArray(const vector<T>& values) {
+        put<uint64_t>(values.size());
+        if (!values.empty()) {
+            bytes.append(reinterpret_cast<const char*>(values.data()), values.size() * sizeof(T));
+        }
+    }
+
+    void putString(const string& s) {
+        put<uint32_t>(s.size());
+        bytes.append(s);
+    }
+
+    const string& str() const {
+        return bytes;
+    }
+};
+
+// Read back what ByteWriter wrote; throws if the data is shorter than expected
+class ByteReader {
+private:
+    const string& bytes;
+    size_t position;
+
+    void need(size_t count) {
+        if (position + count > bytes.size()) {
+            throw runtime_error("Snapshot section is truncated");
+        }
+    }
+
+public:
+    ByteReader(const string& data) : bytes(data), position(0) {}
+
+    template <typename T>
+    T get() {
+        need(sizeof(T));
+        T value;
+        memcpy(&value, bytes.data() + position, sizeof(T));
+        position += sizeof(T);
+        return value;
+    }
+
+    template <typename T>
+    vector<T> getArray() {
+        uint64_t count = get<uint64_t>();
+        need(count * sizeof(T));
+        vector<T> values(count);
+        if (count > 0) {
+            memcpy(values.data(), bytes.data() + position, count * sizeof(T));
+        }
+        position += count * sizeof(T);
+        return values;
+    }
+
+    string getString() {
+        uint32_t length = get<uint32_t>();
+        need(length);
+        string s = bytes.substr(position, length);
+        position += length;
+        return s;
+    }
+
+    bool done() const {
+        return position >= bytes.size();
+    }
+};
+
+// A graph snapshot file: a magic header followed by tagged sections.
+//   "CGS1" | repeat { 4-byte tag | uint64 length | payload }
+// The graph itself lives in PTYP/NODE/EDGE; precomputed data (partitions,
+// speedup structures, ...) is stored in further sections that older readers skip.
+class SnapshotFile {
+private:
+    map<string, string> sections;
+
+public:
+    bool has(const string& tag) const {
+        return sections.count(tag) > 0;
+    }
+
+    const string& section(const string& tag) const {
+        auto it = sections.find(tag);
+        if (it == sections.end()) throw runtime_error("Snapshot has no " + tag + " section");
+        return it->second;
+    }
+
+    void setSection(const string& tag, const string& payload) {
+        if (tag.size() != 4) throw invalid_argument("Section tags are 4 characters");
+        sections[tag] = payload;
+    }
+
+    void removeSection(const string& tag) {
+        sections.erase(tag);
+    }
+
+    void putGraph(const Graph& g) {
+        ByteWriter types;
+        types.put<uint32_t>(g.getPathTypes().size());
+        for (const auto& t : g.getPathTypes()) types.putString(t);
+        setSection("PTYP", types.str());
+
+        ByteWriter nodes;
+        nodes.put<uint64_t>(g.size());
+        for (const auto& node : g.getNodes()) {
+            nodes.put<double>(node.x);
+            nodes.put<double>(node.y);
+            nodes.putString(node.name);
+            nodes.putString(node.type);
+        }
+        setSection("NODE", nodes.str());
+
+        ByteWriter edges;
+        edges.put<uint64_t>(g.getEdges().size());
+        for (const auto& e : g.getEdges()) {
+            edges.put<int32_t>(e.from);
+            edges.put<int32_t>(e.to);
+            edges.put<int32_t>(e.weight);
+            edges.put<uint8_t>(e.closed ? 1 : 0);
+            edges.putString(e.pathType);
+        }
+        setSection("EDGE", edges.str());
+
+        ByteWriter meta;
+        meta.put<uint64_t>(g.getVersion());
+        setSection("META", meta.str());
+
+        // Attribute bits of each edge
+        ByteWriter attributes;
+        vector<uint8_t> edgeAttributes;
+        for (const auto& e : g.getEdges()) edgeAttributes.push_back(e.attributes);
+        attributes.putArray(edgeAttributes);
+        setSection("EATR", attributes.str());
+
+        // Travel-time profiles: the flat profile arrays, then the profile of each edge
+        bool anyProfile = false;
+        for (const auto& e : g.getEdges()) anyProfile = anyProfile || e.profile >= 0;
+        if (anyProfile) {
+            ByteWriter profiles;
+            profiles.putArray(g.getProfiles().allPoints());
+            profiles.putArray(g.getProfiles().allOffsets());
+            vector<int32_t> edgeProfiles;
+            for (const auto& e : g.getEdges()) edgeProfiles.push_back(e.profile);
+            profiles.putArray(edgeProfiles);
+            setSection("TDPR", profiles.str());
+        }
+        else {
+            sections.erase("TDPR");
+        }
+
+        // Partition cell of each node, in internal order
+        if (g.hasCells()) {
+            ByteWriter cells;
+            cells.putArray(g.getCells());
+            setSection("PART", cells.str());
+        }
+        else {
+            sections.erase("PART");
+        }
+
+        // External ids of renumbered graphs, in internal order
+        if (g.isRenumbered()) {
+            ByteWriter ids;
+            ids.putArray(g.getExternalIds());
+            setSection("XIDS", ids.str());
+        }
+        else {
+            sections.erase("XIDS");
+        }
+    }
+
+    // Rebuild the graph; the result is finalized and ready to query
+    Graph getGraph(bool perfectNameIndex = true) const {
+        ByteReader nodes(section("NODE"));
+        uint64_t nodeCount = nodes.get<uint64_t>();
+        Graph g(nodeCount);
+        for (uint64_t i = 0; i < nodeCount; i++) {
+            double x = nodes.get<double>();
+            double y = nodes.get<double>();
+            string name = nodes.getString();
+            string type = nodes.getString();
+            g.addNode(i, name, x, y, type);
+        }
+
+        ByteReader edges(section("EDGE"));
+        uint64_t edgeCount = edges.get<uint64_t>();
+        for (uint64_t i = 0; i < edgeCount; i++) {
+            int from = edges.get<int32_t>();
+            int to = edges.get<int32_t>();
+            int weight = edges.get<int32_t>();
+            bool closed = edges.get<uint8_t>() != 0;
+            string pathType = edges.getString();
+            g.addEdge(from, to, weight, pathType);
+            if (closed) g.setEdgeClosed(g.getEdges().size() - 1, true);
+        }
+
+        if (has("META")) {
+            ByteReader meta(section("META"));
+            g.setVersion(meta.get<uint64_t>());
+        }
+
+        // Snapshots without EATR keep the defaults derived from the path type
+        if (has("EATR")) {
+            ByteReader attributes(section("EATR"));
+            vector<uint8_t> edgeAttributes = attributes.getArray<uint8_t>();
+            if (edgeAttributes.size() != edgeCount) throw runtime_error("Snapshot EATR section does not match EDGE");
+            for (uint64_t i = 0; i < edgeCount; i++) g.setEdgeAttributes(i, edgeAttributes[i]);
+        }
+
+        if (has("TDPR")) {
+            ByteReader profiles(section("TDPR"));
+            vector<ProfilePoint> points = profiles.getArray<ProfilePoint>();
+            vector<uint32_t> offsets = profiles.getArray<uint32_t>();
+            vector<int32_t> edgeProfiles = profiles.getArray<int32_t>();
+            if (edgeProfiles.size() != edgeCount) throw runtime_error("Snapshot TDPR section does not match EDGE");
+            g.restoreProfiles(move(points), move(offsets), edgeProfiles);
+        }
+
+        // Boundary nodes and cut size are derived again from the edges
+        if (has("PART")) {
+            ByteReader cells(section("PART"));
+            vector<int> cellOf = cells.getArray<int>();
+            if (cellOf.size() != nodeCount) throw runtime_error("Snapshot PART section does not match NODE");
+            g.setCells(cellOf);
+        }
+
+        if (has("XIDS")) {
+            ByteReader ids(section("XIDS"));
+            vector<int> externalIds = ids.getArray<int>();
+            if (externalIds.size() != nodeCount) throw runtime_error("Snapshot XIDS section does not match NODE");
+            g.setExternalIds(externalIds);
+        }
+
+        g.finalize(perfectNameIndex);
+        return g;
+    }
+
+    void save(const string& path) const {
+        ofstream out(path, ios::binary);
+        if (!out) throw runtime_error("Cannot write snapshot " + path);
+        out.write("CGS1", 4);
+        for (const auto& s : sections) {
+            uint64_t length = s.second.size();
+            out.write(s.first.data(), 4);
+            out.write(reinterpret_cast<const char*>(&length), sizeof(length));
+            out.write(s.second.data(), length);
+        }
+        out.close();
+        if (!out) throw runtime_error("Failed writing snapshot " + path);
+    }
+
+    static SnapshotFile load(const string& path) {
+        ifstream in(path, ios::binary);
+        if (!in) throw runtime_error("Cannot open snapshot " + path);
+
+        char magic[4];
+        if (!in.read(magic, 4) || memcmp(magic, "CGS1", 4) != 0) {
+            throw runtime_error(path + " is not a campus graph snapshot");
+        }
+
+        SnapshotFile file;
+        char tag[4];
+        while (in.read(tag, 4)) {
+            uint64_t length;
+            if (!in.read(reinterpret_cast<char*>(&length), sizeof(length))) {
+                throw runtime_error("Snapshot " + path + " is truncated");
+            }
+            string payload(length, '\0');
+            if (!in.read(&payload[0], length)) {
+                throw runtime_error("Snapshot " + path + " is truncated");
+            }
+            file.sections[string(tag, 4)] = move(payload);
+        }
+        return file;
+    }
+};
+
+// Convenience wrappers for the plain graph
+void saveGraphSnapshot(const Graph& g, const string& path) {
+    SnapshotFile file;
+    file.putGraph(g);
+    file.save(path);
+}
+
+Graph loadGraphSnapshot(const string& path) {
+    return SnapshotFile::load(path).getGraph();
+}
@@ -154,7 +154,7 @@ public:
         
         json result;           // Build JSON response with all sorting information
         result["algorithm"] = "quicksort";
-        result["referenceNode"] = referenceNodeId;
+        result["referenceNode"] = graph.toExternal(referenceNodeId);
         result["referenceName"] = referenceNode.name;
         
         result["sortedLocations"] = json::array();           // Add sorted locations to result
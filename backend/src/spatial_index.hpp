@@ -0,0 +1,109 @@
+#pragma once
+#include <vector>
+#include <algorithm>
+#include <queue>
+#include <utility>
+#include <cmath>
+
+using namespace std;
+
+// Static 2-d tree over node coordinates, stored implicitly: the subtree over
+// points[lo, hi) has its splitting point at the middle index, split on x at even
+// depths and on y at odd depths. Built once with nth_element in O(n log n).
+class KdTree {
+public:
+    struct Point {
+        double x, y;
+        int id;
+    };
+
+private:
+    vector<Point> points;
+
+    static double coord(const Point& p, int axis) {
+        return axis == 0 ? p.x : p.y;
+    }
+
+    void build(int lo, int hi, int axis) {
+        if (hi - lo <= 1) return;
+        int mid = lo + (hi - lo) / 2;
+        nth_element(points.begin() + lo, points.begin() + mid, points.begin() + hi,
+                    [axis](const Point& a, const Point& b) { return coord(a, axis) < coord(b, axis); });
+        build(lo, mid, axis ^ 1);
+        build(mid + 1, hi, axis ^ 1);
+    }
+
+    // Max-heap of (squared distance, id) holding the k best candidates so far
+    using Candidates = priority_queue<pair<double, int>>;
+
+    void nearest(int lo, int hi, int axis, double x, double y, size_t k, Candidates& best) const {
+        if (lo >= hi) return;
+        int mid = lo + (hi - lo) / 2;
+        const Point& p = points[mid];
+
+        double dx = p.x - x, dy = p.y - y;
+        double d2 = dx * dx + dy * dy;
+        if (best.size() < k) best.push({d2, p.id});
+        else if (d2 < best.top().first) {
+            best.pop();
+            best.push({d2, p.id});
+        }
+
+        double diff = (axis == 0 ? x : y) - coord(p, axis);
+        int nearLo = diff < 0 ? lo : mid + 1, nearHi = diff < 0 ? mid : hi;
+        int farLo = diff < 0 ? mid + 1 : lo, farHi = diff < 0 ? hi : mid;
+
+        nearest(nearLo, nearHi, axis ^ 1, x, y, k, best);
+        // Only cross the split if the ball around the query still reaches the other side
+        if (best.size() < k || diff * diff < best.top().first) {
+            nearest(farLo, farHi, axis ^ 1, x, y, k, best);
+        }
+    }
+
+    void inBox(int lo, int hi, int axis, double minX, double minY, double maxX, double maxY,
+               vector<int>& out) const {
+        if (lo >= hi) return;
+        int mid = lo + (hi - lo) / 2;
+        const Point& p = points[mid];
+
+        if (p.x >= minX && p.x <= maxX && p.y >= minY && p.y <= maxY) out.push_back(p.id);
+
+        double value = coord(p, axis);
+        double low = axis == 0 ? minX : minY;
+        double high = axis == 0 ? maxX : maxY;
+        if (low <= value) inBox(lo, mid, axis ^ 1, minX, minY, maxX, maxY, out);
+        if (high >= value) inBox(mid + 1, hi, axis ^ 1, minX, minY, maxX, maxY, out);
+    }
+
+public:
+    void build(vector<Point> input) {
+        points = move(input);
+        build(0, points.size(), 0);
+    }
+
+    // Up to k nearest points as (distance, id), closest first
+    vector<pair<double, int>> nearest(double x, double y, size_t k) const {
+        vector<pair<double, int>> result;
+        if (k == 0 || points.empty()) return result;
+
+        Candidates best;
+        nearest(0, points.size(), 0, x, y, k, best);
+        while (!best.empty()) {
+            result.push_back({sqrt(best.top().first), best.top().second});
+            best.pop();
+        }
+        reverse(result.begin(), result.end());
+        return result;
+    }
+
+    // Ids of all points inside the closed rectangle
+    vector<int> inBox(double minX, double minY, double maxX, double maxY) const {
+        vector<int> result;
+        inBox(0, points.size(), 0, minX, minY, maxX, maxY, result);
+        return result;
+    }
+
+    size_t memoryUsage() const {
+        return points.capacity() * sizeof(Point);
+    }
+};
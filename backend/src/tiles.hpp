@@ -0,0 +1,221 @@
+#pragma once
+#include "graph.hpp"
+#include "graph_json.hpp"
+#include "../lib/json.hpp"
+#include <vector>
+#include <string>
+#include <unordered_map>
+#include <list>
+#include <mutex>
+#include <cmath>
+#include <algorithm>
+#include <stdexcept>
+
+using json = nlohmann::json;
+using namespace std;
+
+// Level-of-detail rank of a path type: 0 = major (roads), 1 = walkways, 2 = minor
+int pathTypeRank(const string& pathType) {
+    if (pathType == "road") return 0;
+    if (pathType == "walkway") return 1;
+    return 2;
+}
+
+// Graph split into square map tiles for viewport queries. Zoom z divides the
+// square around all nodes into 2^z x 2^z tiles; the deepest zoom has about
+// `nodesPerTile` nodes per tile. Each edge belongs to the tile holding its
+// midpoint, and coarse zooms keep only major paths:
+//   maxZoom: every edge, maxZoom-1: rank <= 1, below that: roads only,
+// and below maxZoom at most 2 * nodesPerTile edges per tile (lowest rank, then longest).
+// A tile lists its edges and their end nodes (plus, at maxZoom, the nodes
+// lying in it), so nodes near tile borders can appear in two tiles.
+// Rendered tiles are cached up to cacheBytes, least recently used first out;
+// the index belongs to one graph version.
+class TileIndex {
+private:
+    uint64_t version;
+    double originX = 0, originY = 0, extent = 1;
+    int maxZoom = 0;
+    vector<vector<int>> edgeOffset;  // per zoom: CSR over tiles (row-major) into tileEdges
+    vector<vector<int>> tileEdges;
+    vector<int> nodeOffset, tileNodes;  // nodes by maxZoom tile
+
+    // Rendered tiles, most recently used first
+    size_t cacheCapacity;
+    mutable mutex cacheMutex;
+    mutable list<pair<uint64_t, string>> rendered;
+    mutable unordered_map<uint64_t, list<pair<uint64_t, string>>::iterator> renderedIndex;
+    mutable size_t renderedBytes = 0;
+    static const size_t entryOverhead = 64;  // list node and map node, roughly
+
+    int tileOf(double value, double origin, int zoom) const {
+        int tiles = 1 << zoom;
+        double t = floor((value - origin) / extent * tiles);
+        return static_cast<int>(min(max(t, 0.0), tiles - 1.0));
+    }
+
+    static uint64_t tileKey(int zoom, int x, int y) {
+        return (uint64_t(zoom) << 58) | (uint64_t(x) << 29) | uint64_t(y);
+    }
+
+    // Counting sort of items into the tiles of one zoom level
+    static void bucket(const vector<int>& tileOfItem, const vector<int>& items, int tileCount,
+                       vector<int>& offset, vector<int>& sorted) {
+        offset.assign(tileCount + 1, 0);
+        for (size_t i = 0; i < items.size(); i++) offset[tileOfItem[i] + 1]++;
+        for (int t = 0; t < tileCount; t++) offset[t + 1] += offset[t];
+        sorted.resize(items.size());
+        vector<int> fill(offset.begin(), offset.end() - 1);
+        for (size_t i = 0; i < items.size(); i++) sorted[fill[tileOfItem[i]]++] = items[i];
+    }
+
+public:
+    TileIndex(const Graph& g, int nodesPerTile = 256, size_t cacheBytes = 16 * 1024 * 1024)
+        : version(g.getVersion()), cacheCapacity(cacheBytes) {
+        size_t edgeBudget = 2 * nodesPerTile;
+        int n = g.size();
+        if (n > 0) {
+            double minX = g.getNode(0).x, maxX = minX, minY = g.getNode(0).y, maxY = minY;
+            for (const auto& node : g.getNodes()) {
+                minX = min(minX, node.x); maxX = max(maxX, node.x);
+                minY = min(minY, node.y); maxY = max(maxY, node.y);
+            }
+            originX = minX;
+            originY = minY;
+            extent = max(max(maxX - minX, maxY - minY), 1.0) * 1.0001;  // keep the max edge inside
+        }
+        while (maxZoom < 12 && (static_cast<long long>(nodesPerTile) << (2 * maxZoom)) < n) maxZoom++;
+
+        const auto& edges = g.getEdges();
+        edgeOffset.resize(maxZoom + 1);
+        tileEdges.resize(maxZoom + 1);
+        for (int z = 0; z <= maxZoom; z++) {
+            int allowedRank = max(0, 2 - (maxZoom - z));
+            vector<int> items, tiles;
+            for (size_t i = 0; i < edges.size(); i++) {
+                if (pathTypeRank(edges[i].pathType) > allowedRank) continue;
+                const Node& a = g.getNode(edges[i].from);
+                const Node& b = g.getNode(edges[i].to);
+                int tx = tileOf((a.x + b.x) / 2, originX, z);
+                int ty = tileOf((a.y + b.y) / 2, originY, z);
+                items.push_back(i);
+                tiles.push_back(ty * (1 << z) + tx);
+            }
+            bucket(tiles, items, 1 << (2 * z), edgeOffset[z], tileEdges[z]);
+            if (z == maxZoom) continue;
+
+            // Simplify coarse tiles down to their most prominent edges
+            auto prominence = [&](int e) {
+                const Node& a = g.getNode(edges[e].from);
+                const Node& b = g.getNode(edges[e].to);
+                return make_pair(pathTypeRank(edges[e].pathType), -hypot(a.x - b.x, a.y - b.y));
+            };
+            vector<int>& offset = edgeOffset[z];
+            vector<int>& list = tileEdges[z];
+            int kept = 0;
+            for (size_t t = 0; t + 1 < offset.size(); t++) {
+                auto first = list.begin() + offset[t], last = list.begin() + offset[t + 1];
+                if ((size_t)(last - first) > edgeBudget) {
+                    partial_sort(first, first + edgeBudget, last, [&](int a, int b) { return prominence(a) < prominence(b); });
+                    last = first + edgeBudget;
+                }
+                offset[t] = kept;
+                for (auto it = first; it != last; ++it) list[kept++] = *it;
+            }
+            offset.back() = kept;
+            list.resize(kept);
+        }
+
+        vector<int> items(n), tiles(n);
+        for (int i = 0; i < n; i++) {
+            items[i] = i;
+            tiles[i] = tileOf(g.getNode(i).y, originY, maxZoom) * (1 << maxZoom) + tileOf(g.getNode(i).x, originX, maxZoom);
+        }
+        bucket(tiles, items, 1 << (2 * maxZoom), nodeOffset, tileNodes);
+    }
+
+    uint64_t getVersion() const {
+        return version;
+    }
+
+    int getMaxZoom() const {
+        return maxZoom;
+    }
+
+    // Index arrays plus rendered tiles, in bytes
+    size_t memoryUsage() const {
+        size_t bytes = (nodeOffset.capacity() + tileNodes.capacity()) * sizeof(int);
+        for (int z = 0; z <= maxZoom; z++) {
+            bytes += (edgeOffset[z].capacity() + tileEdges[z].capacity()) * sizeof(int);
+        }
+        lock_guard<mutex> lock(cacheMutex);
+        return bytes + renderedBytes;
+    }
+
+    // Tile grid description so clients can compute tile coordinates themselves
+    json gridJSON() const {
+        return {{"originX", originX}, {"originY", originY}, {"extent", extent}, {"maxZoom", maxZoom}};
+    }
+
+    // Tiles of one zoom level overlapping a rectangle, as (x, y) pairs
+    vector<pair<int, int>> tilesInBox(int zoom, double minX, double minY, double maxX, double maxY) const {
+        vector<pair<int, int>> result;
+        int x0 = tileOf(minX, originX, zoom), x1 = tileOf(maxX, originX, zoom);
+        int y0 = tileOf(minY, originY, zoom), y1 = tileOf(maxY, originY, zoom);
+        for (int y = y0; y <= y1; y++) {
+            for (int x = x0; x <= x1; x++) result.push_back({x, y});
+        }
+        return result;
+    }
+
+    // JSON text of one tile: {"z", "x", "y", "nodes": [...], "edges": [...]}
+    string tileJSON(const Graph& g, int zoom, int x, int y) const {
+        if (zoom < 0 || zoom > maxZoom || x < 0 || y < 0 || x >= (1 << zoom) || y >= (1 << zoom)) {
+            throw invalid_argument("Tile out of range");
+        }
+        uint64_t key = tileKey(zoom, x, y);
+        {
+            lock_guard<mutex> lock(cacheMutex);
+            auto it = renderedIndex.find(key);
+            if (it != renderedIndex.end()) {
+                rendered.splice(rendered.begin(), rendered, it->second);
+                return it->second->second;
+            }
+        }
+
+        json tile;
+        tile["z"] = zoom;
+        tile["x"] = x;
+        tile["y"] = y;
+        tile["nodes"] = json::array();
+        tile["edges"] = json::array();
+
+        vector<int> nodeIds;
+        int t = y * (1 << zoom) + x;
+        for (int k = edgeOffset[zoom][t]; k < edgeOffset[zoom][t + 1]; k++) {
+            const Edge& e = g.getEdges()[tileEdges[zoom][k]];
+            tile["edges"].push_back(edgeToJSON(g, tileEdges[zoom][k]));
+            nodeIds.push_back(e.from);
+            nodeIds.push_back(e.to);
+        }
+        if (zoom == maxZoom) {
+            nodeIds.insert(nodeIds.end(), tileNodes.begin() + nodeOffset[t], tileNodes.begin() + nodeOffset[t + 1]);
+        }
+        sort(nodeIds.begin(), nodeIds.end());
+        nodeIds.erase(unique(nodeIds.begin(), nodeIds.end()), nodeIds.end());
+        for (int id : nodeIds) tile["nodes"].push_back(nodeToJSON(g.getNode(id)));
+
+        string text = tile.dump();
+        lock_guard<mutex> lock(cacheMutex);
+        if (renderedIndex.count(key) || text.size() + entryOverhead > cacheCapacity) return text;
+        rendered.push_front({key, text});
+        renderedIndex[key] = rendered.begin();
+        renderedBytes += text.size() + entryOverhead;
+        while (renderedBytes > cacheCapacity) {
+            renderedBytes -= rendered.back().second.size() + entryOverhead;
+            renderedIndex.erase(rendered.back().first);
+            rendered.pop_back();
+        }
+        return text;
+    }
+};
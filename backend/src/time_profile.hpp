@@ -0,0 +1,128 @@
+#pragma once
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <cstdio>
+#include <algorithm>
+#include <stdexcept>
+
+using namespace std;
+
+const int SECONDS_PER_DAY = 24 * 60 * 60;
+const double WALKING_SPEED = 1.4;  // m/s, travel time of edges without a profile
+
+// One breakpoint of a travel-time profile: entering the edge at `time`
+// (seconds after midnight) takes `seconds` to cross it
+struct ProfilePoint {
+    int32_t time;
+    int32_t seconds;
+};
+
+// "HH:MM" (or "HH:MM:SS") -> seconds after midnight
+int parseTimeOfDay(const string& text) {
+    int h = 0, m = 0, s = 0, minutesEnd = -1, secondsEnd = -1;
+    int fields = sscanf(text.c_str(), "%d:%d%n:%d%n", &h, &m, &minutesEnd, &s, &secondsEnd);
+    int used = fields == 3 ? secondsEnd : minutesEnd;
+    if (fields < 2 || used != (int)text.size() || h < 0 || h > 23 || m < 0 || m > 59 || s < 0 || s > 59) {
+        throw invalid_argument("Time must be HH:MM");
+    }
+    return h * 3600 + m * 60 + s;
+}
+
+// Seconds after midnight -> "HH:MM", wrapping past midnight
+string formatTimeOfDay(long long seconds) {
+    int t = static_cast<int>(((seconds % SECONDS_PER_DAY) + SECONDS_PER_DAY) % SECONDS_PER_DAY);
+    char text[8];
+    snprintf(text, sizeof(text), "%02d:%02d", t / 3600, (t / 60) % 60);
+    return text;
+}
+
+// Piecewise-linear travel-time functions over the day, all stored in one flat
+// array: profile p is points[offsets[p] .. offsets[p+1]), sorted by time. Between
+// breakpoints the value is interpolated; it wraps around midnight.
+//
+// Profiles must be FIFO (leaving later never arrives earlier): the travel time may
+// fall by at most the time that passes. Waiting for a gate to open has slope -1
+// and is allowed. This keeps plain label-setting Dijkstra exact.
+class TravelTimeProfiles {
+private:
+    vector<ProfilePoint> points;
+    vector<uint32_t> offsets{0};
+
+public:
+    // Validate and store a profile, returning its index
+    int add(vector<ProfilePoint> profile) {
+        if (profile.empty()) throw invalid_argument("Profile needs at least one point");
+        sort(profile.begin(), profile.end(),
+             [](const ProfilePoint& a, const ProfilePoint& b) { return a.time < b.time; });
+        for (size_t i = 0; i < profile.size(); i++) {
+            const ProfilePoint& p = profile[i];
+            if (p.time < 0 || p.time >= SECONDS_PER_DAY) throw invalid_argument("Profile time out of range");
+            if (p.seconds <= 0) throw invalid_argument("Profile travel time must be positive");
+            const ProfilePoint& next = profile[(i + 1) % profile.size()];
+            int gap = (i + 1 < profile.size()) ? next.time - p.time : next.time + SECONDS_PER_DAY - p.time;
+            if (gap == 0 && profile.size() > 1) throw invalid_argument("Profile has two points at the same time");
+            if (p.seconds - next.seconds > gap) throw invalid_argument("Profile is not FIFO (travel time drops faster than time passes)");
+        }
+        points.insert(points.end(), profile.begin(), profile.end());
+        offsets.push_back(points.size());
+        return offsets.size() - 2;
+    }
+
+    // Travel time in seconds when entering at `when` (seconds, any day)
+    int evaluate(int profile, long long when) const {
+        const ProfilePoint* first = points.data() + offsets[profile];
+        const ProfilePoint* last = points.data() + offsets[profile + 1];
+        if (last - first == 1) return first->seconds;
+
+        int t = static_cast<int>(((when % SECONDS_PER_DAY) + SECONDS_PER_DAY) % SECONDS_PER_DAY);
+        const ProfilePoint* after = upper_bound(first, last, t,
+                                                [](int value, const ProfilePoint& p) { return value < p.time; });
+        // Neighbouring breakpoints, wrapping around midnight
+        const ProfilePoint* before = (after == first) ? last - 1 : after - 1;
+        if (after == last) after = first;
+        int beforeTime = before->time, afterTime = after->time;
+        if (beforeTime > t) beforeTime -= SECONDS_PER_DAY;
+        if (afterTime <= t) afterTime += SECONDS_PER_DAY;
+
+        double fraction = double(t - beforeTime) / (afterTime - beforeTime);
+        return static_cast<int>(before->seconds + fraction * (after->seconds - before->seconds) + 0.5);
+    }
+
+    // Shortest travel time of a profile over the day (interpolation never goes below a breakpoint)
+    int minimum(int profile) const {
+        int best = points[offsets[profile]].seconds;
+        for (uint32_t i = offsets[profile]; i < offsets[profile + 1]; i++) best = min(best, points[i].seconds);
+        return best;
+    }
+
+    // Breakpoints of one profile
+    vector<ProfilePoint> get(int profile) const {
+        return vector<ProfilePoint>(points.begin() + offsets[profile], points.begin() + offsets[profile + 1]);
+    }
+
+    size_t count() const {
+        return offsets.size() - 1;
+    }
+
+    const vector<ProfilePoint>& allPoints() const {
+        return points;
+    }
+
+    const vector<uint32_t>& allOffsets() const {
+        return offsets;
+    }
+
+    // Restore from the flat arrays (snapshot loading)
+    void assign(vector<ProfilePoint> allPoints, vector<uint32_t> allOffsets) {
+        bool valid = !allOffsets.empty() && allOffsets.front() == 0 && allOffsets.back() == allPoints.size();
+        for (size_t i = 0; valid && i + 1 < allOffsets.size(); i++) valid = allOffsets[i] < allOffsets[i + 1];
+        if (!valid) throw runtime_error("Inconsistent travel-time profiles");
+        points = move(allPoints);
+        offsets = move(allOffsets);
+    }
+
+    size_t memoryUsage() const {
+        return points.capacity() * sizeof(ProfilePoint) + offsets.capacity() * sizeof(uint32_t);
+    }
+};
@@ -4,6 +4,8 @@
 #include <vector>
 #include <algorithm>
 #include <map>
+#include <cstdlib>
+#include <stdexcept>
 
 using namespace std;
 
@@ -66,51 +68,113 @@ map<string, string> parseQueryParams(const string& query){
     return params;
 }
 
+// Extract the method (GET, POST, ...) from the HTTP request line
+string extractMethod(const string& request){
+    size_t end = request.find(' ');
+    if (end == string::npos) return "";
+    return request.substr(0, end);
+}
+
+// Extract the request target ("/path?query") from the HTTP request line
+string extractTarget(const string& request){
+    size_t start = request.find(' ');
+    if (start == string::npos) return "";
+
+    start += 1; // Skip "METHOD "
+    size_t end = request.find(" HTTP/", start);
+    if (end == string::npos) return "";
+
+    return trim(request.substr(start, end - start));
+}
+
 // Extract path from HTTP request
 string extractPath(const string& request){ 
-   size_t start = request.find("GET");
-    if (start == string::npos) return "/";
-    
-    start += 4; // Skip "GET "
-    size_t end = request.find(" HTTP/", start);
-    
-    if (end != string::npos){
-        string fullPath = request.substr(start, end - start);
-        fullPath = trim(fullPath); // Trim whitespace
-        
-        size_t questionPosition = fullPath.find('?');
-        
-        // Return path without query parameters
-        if (questionPosition != string::npos){
-            return fullPath.substr(0, questionPosition);
-        }
-        else {
-            return fullPath;
-        }
+    string fullPath = extractTarget(request);
+    if (fullPath.empty()) return "/";
+
+    size_t questionPosition = fullPath.find('?');
+
+    // Return path without query parameters
+    if (questionPosition != string::npos){
+        return fullPath.substr(0, questionPosition);
+    }
+    else {
+        return fullPath;
     }
-    return "/";
 }
 
 // Extract query string from HTTP request
 string extractQueryString(const string& request){
-    size_t start = request.find("GET");
-    if (start == string::npos) return "";
-    
-    start += 4; // Skip "GET "
-    size_t end = request.find(" HTTP/", start);
-    
-    if (end != string::npos){
-        string fullPath = request.substr(start, end - start);
-        fullPath = trim(fullPath); // Trim whitespace
-        
-        size_t questionPosition = fullPath.find('?');
-        
-        // Return everything after the '?'
-        if (questionPosition != string::npos){
-            return fullPath.substr(questionPosition + 1);
-        } else {
-            return "";
-        }
+    string fullPath = extractTarget(request);
+    size_t questionPosition = fullPath.find('?');
+
+    // Return everything after the '?'
+    if (questionPosition != string::npos){
+        return fullPath.substr(questionPosition + 1);
+    } else {
+        return "";
+    }
+}
+
+// Parse "minX,minY,maxX,maxY"; throws if it does not hold four numbers
+void parseBoundingBox(const string& text, double& minX, double& minY, double& maxX, double& maxY){
+    double values[4];
+    istringstream stream(text);
+    string part;
+    int count = 0;
+    while (count < 4 && getline(stream, part, ',')){
+        values[count++] = stod(part);
     }
-    return "";
-}
\ No newline at end of file
+    if (count != 4) throw invalid_argument("bbox must be minX,minY,maxX,maxY");
+
+    minX = min(values[0], values[2]);
+    maxX = max(values[0], values[2]);
+    minY = min(values[1], values[3]);
+    maxY = max(values[1], values[3]);
+}
+
+// Strip a campus prefix: "/api/north/dijkstra" -> "/api/dijkstra" with campusId = "north".
+// Paths with a single segment after /api/ are left alone and keep the given campusId.
+string splitCampusPath(const string& path, string& campusId){
+    const string prefix = "/api/";
+    if (path.compare(0, prefix.size(), prefix) != 0) return path;
+
+    size_t slash = path.find('/', prefix.size());
+    if (slash == string::npos) return path;
+
+    campusId = path.substr(prefix.size(), slash - prefix.size());
+    return prefix + path.substr(slash + 1);
+}
+
+// Value of the Content-Length header, 0 if absent
+size_t extractContentLength(const string& request){
+    size_t headerEnd = request.find("\r\n\r\n");
+    string headers = request.substr(0, headerEnd);
+    transform(headers.begin(), headers.end(), headers.begin(), ::tolower);
+
+    size_t position = headers.find("content-length:");
+    if (position == string::npos) return 0;
+    return strtoul(headers.c_str() + position + 15, nullptr, 10);
+}
+
+// Value of a request header (name matched case-insensitively), empty if absent
+string extractHeader(const string& request, const string& name){
+    size_t headerEnd = request.find("\r\n\r\n");
+    string headers = request.substr(0, headerEnd);
+    string lowerHeaders = headers, lowerName = name + ":";
+    transform(lowerHeaders.begin(), lowerHeaders.end(), lowerHeaders.begin(), ::tolower);
+    transform(lowerName.begin(), lowerName.end(), lowerName.begin(), ::tolower);
+
+    size_t position = lowerHeaders.find("\r\n" + lowerName);
+    if (position == string::npos) return "";
+    position += 2 + lowerName.size();
+    size_t lineEnd = headers.find("\r\n", position);
+    return trim(headers.substr(position, lineEnd == string::npos ? string::npos : lineEnd - position));
+}
+
+// Extract the body (everything after the blank line) from HTTP request
+string extractBody(const string& request){
+    size_t headerEnd = request.find("\r\n\r\n");
+    if (headerEnd == string::npos) return "";
+    return request.substr(headerEnd + 4);
+}
@@ -0,0 +1,124 @@
+#pragma once
+#include "graph.hpp"
+#include "frontier.hpp"
+#include <vector>
+#include <atomic>
+#include <cstdint>
+#include <algorithm>
+
+using namespace std;
+
+// Bumped when a campus is unloaded; see WorkspaceTrim
+atomic<uint64_t> searchMemoryGeneration{0};
+
+// Call after unloading a graph so each thread's next search can give back
+// search memory sized for it
+void releaseSearchMemory() {
+    searchMemoryGeneration++;
+}
+
+// When a thread's search memory, sized for the largest graph it has searched,
+// should shrink to the graph at hand: once it is more than four times larger,
+// and either a campus was unloaded since the last search or the last 256
+// searches all ran on smaller graphs. Alternating campuses keep their memory.
+class WorkspaceTrim {
+private:
+    int sizedFor = 0;
+    int smallSearches = 0;
+    uint64_t generation = 0;
+
+public:
+    // True if memory sized for sizedFor nodes should be released before this search
+    bool before(int nodeCount) {
+        uint64_t current = searchMemoryGeneration.load();
+        bool oversized = sizedFor > 4 * max(nodeCount, 1024);
+        bool trim = oversized && (current != generation || ++smallSearches >= 256);
+        if (!oversized || trim) smallSearches = 0;
+        generation = current;
+        if (trim) sizedFor = 0;
+        sizedFor = max(sizedFor, nodeCount);
+        return trim;
+    }
+};
+
+// Per-node labels of one search, kept by each thread and reused by its next
+// search. Every label carries the epoch of the search that last wrote it; a
+// label from an older epoch reads as fresh, so starting a search is O(1) instead
+// of refilling n entries, and a short route on a huge graph only pays for the
+// nodes it touches.
+class SearchWorkspace {
+public:
+    struct Label {
+        int dist = INF;
+        int previous = -1;
+        int length = 0;     // meters along the current best path
+        char settled = 0;
+        char flag = 0;      // for the caller, e.g. to mark targets
+    };
+
+private:
+    vector<Label> labels;
+    vector<uint32_t> stamp;
+    uint32_t epoch = 0;
+    WorkspaceTrim trim;
+
+public:
+    // Start a search over nodeCount nodes: every label reads as fresh again
+    void reset(int nodeCount) {
+        if (trim.before(nodeCount)) {
+            vector<Label>().swap(labels);
+            vector<uint32_t>().swap(stamp);
+            epoch = 0;
+        }
+        if ((int)stamp.size() < nodeCount) {
+            labels.resize(nodeCount);
+            stamp.resize(nodeCount, 0);
+        }
+        if (++epoch == 0) {  // wrapped after 2^32 searches: old stamps could match again
+            fill(stamp.begin(), stamp.end(), 0);
+            epoch = 1;
+        }
+    }
+
+    // The label of v, made fresh on its first use in this search
+    Label& operator[](int v) {
+        if (stamp[v] != epoch) {
+            stamp[v] = epoch;
+            labels[v] = Label();
+        }
+        return labels[v];
+    }
+
+    // Read-only access that leaves untouched labels alone
+    int dist(int v) const {
+        return stamp[v] == epoch ? labels[v].dist : INF;
+    }
+
+    bool settled(int v) const {
+        return stamp[v] == epoch && labels[v].settled;
+    }
+
+    size_t memoryUsage() const {
+        return labels.capacity() * sizeof(Label) + stamp.capacity() * sizeof(uint32_t);
+    }
+};
+
+// Workspace `slot` of the calling thread, reset for a search over nodeCount nodes.
+// Searches with two directions (bidirectional, hierarchy queries) use slots 0 and 1;
+// a search must not call another one that takes the same slot.
+SearchWorkspace& searchWorkspace(int nodeCount, int slot = 0) {
+    static thread_local SearchWorkspace workspaces[2];
+    workspaces[slot].reset(nodeCount);
+    return workspaces[slot];
+}
+
+// Empty frontier of the calling thread, one per frontier type and slot
+template <typename Frontier>
+Frontier& searchFrontier(int nodeCount, int slot = 0) {
+    static thread_local Frontier frontiers[2];
+    static thread_local WorkspaceTrim trims[2];
+    frontiers[slot].clear();
+    if (trims[slot].before(nodeCount)) frontiers[slot].release();
+    frontiers[slot].reserve(nodeCount);
+    return frontiers[slot];
+}
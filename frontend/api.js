@@ -24,15 +24,39 @@ class CampusAPI {
         }
     }
 
+    /**
+     * Changes to the graph since a version the client already has:
+     * {version, full: false, nodes/edges: {added, modified, removed}}, or the
+     * whole graph with full: true when the server no longer has that history.
+     * @param {number} since - Graph version the client holds
+     */
+    async getGraphChanges(since) {
+        try {
+            const response = await fetch(`${this.baseURL}/api/graph?since=${since}`);
+            if (!response.ok) {
+                throw new Error(`HTTP error! status: ${response.status}`);
+            }
+            return await response.json();
+        } catch (error) {
+            console.error('Error fetching graph changes:', error);
+            throw error;
+        }
+    }
+
     /**
      * Get Dijkstra's shortest path
      * @param {number} start - Start node ID
      * @param {number} end - End node ID
+     * @param {string} profile - Routing profile: walk, wheelchair, bike or night
+     * @param {string} algorithm - dijkstra, or astar to search towards the target
+     * @param {string} trace - full for every search step, none for just the path
+     *                         (the server only traces small graphs)
      */
-    async getDijkstra(start, end) {
+    async getDijkstra(start, end, profile = 'walk', algorithm = 'dijkstra', trace = 'full') {
         try {
             const response = await fetch(
-                `${this.baseURL}/api/dijkstra?start=${start}&end=${end}`
+                `${this.baseURL}/api/dijkstra?start=${start}&end=${end}&profile=${encodeURIComponent(profile)}` +
+                `&algorithm=${algorithm}&trace=${trace}`
             );
             if (!response.ok) {
                 throw new Error(`HTTP error! status: ${response.status}`);
@@ -82,12 +106,114 @@ class CampusAPI {
         }
     }
 
+    /**
+     * Find the nodes closest to a point
+     * @param {number} x - X coordinate in graph space
+     * @param {number} y - Y coordinate in graph space
+     * @param {number} k - Number of nodes to return
+     */
+    async getNearest(x, y, k = 1) {
+        try {
+            const response = await fetch(
+                `${this.baseURL}/api/nearest?x=${x}&y=${y}&k=${k}`
+            );
+            if (!response.ok) {
+                throw new Error(`HTTP error! status: ${response.status}`);
+            }
+            return await response.json();
+        } catch (error) {
+            console.error('Error fetching nearest nodes:', error);
+            throw error;
+        }
+    }
+
+    /**
+     * Get the tiled, level-of-detail view of the graph. Tiles are merged into one
+     * {nodes, edges} object; nodes are stored at their id (a sparse array).
+     * The browser revalidates tiles by ETag, so unchanged tiles cost a 304.
+     * @param {Array<number>|null} bbox - [minX, minY, maxX, maxY], null for everything
+     * @param {number} zoom - 0 shows major paths only; higher zooms add detail
+     */
+    async getGraphTiles(bbox, zoom) {
+        try {
+            const box = bbox ? `&bbox=${bbox.join(',')}` : '';
+            const response = await fetch(`${this.baseURL}/api/graph?zoom=${zoom}${box}`);
+            if (!response.ok) {
+                throw new Error(`HTTP error! status: ${response.status}`);
+            }
+            const data = await response.json();
+            const graph = { version: data.version, zoom: data.zoom, grid: data.grid, nodes: [], edges: [] };
+            data.tiles.forEach(tile => {
+                tile.nodes.forEach(node => { graph.nodes[node.id] = node; });
+                graph.edges.push(...tile.edges);
+            });
+            return graph;
+        } catch (error) {
+            console.error('Error fetching graph tiles:', error);
+            throw error;
+        }
+    }
+
+    /* Request counters and size of the graph (cheap, unlike getGraph) */
+    async getMetrics() {
+        try {
+            const response = await fetch(`${this.baseURL}/api/metrics`);
+            if (!response.ok) {
+                throw new Error(`HTTP error! status: ${response.status}`);
+            }
+            return await response.json();
+        } catch (error) {
+            console.error('Error fetching metrics:', error);
+            throw error;
+        }
+    }
+
+    /**
+     * Get the nodes inside a rectangle
+     * @param {Array<number>} bbox - [minX, minY, maxX, maxY] in graph space
+     */
+    async getNodesInBox(bbox) {
+        try {
+            const response = await fetch(
+                `${this.baseURL}/api/nodes?bbox=${bbox.join(',')}`
+            );
+            if (!response.ok) {
+                throw new Error(`HTTP error! status: ${response.status}`);
+            }
+            return await response.json();
+        } catch (error) {
+            console.error('Error fetching nodes in box:', error);
+            throw error;
+        }
+    }
+
+    /**
+     * Change edge weights or close/reopen edges in one batch
+     * @param {Array} updates - e.g. [{from: 2, to: 6, closed: true}, {from: 0, to: 1, weight: 300}]
+     */
+    async updateEdges(updates) {
+        try {
+            const response = await fetch(`${this.baseURL}/api/edges`, {
+                method: 'POST',
+                headers: { 'Content-Type': 'application/json' },
+                body: JSON.stringify({ updates })
+            });
+            if (!response.ok) {
+                throw new Error(`HTTP error! status: ${response.status}`);
+            }
+            return await response.json();
+        } catch (error) {
+            console.error('Error updating edges:', error);
+            throw error;
+        }
+    }
+
     /**
      * Check if server is running
      */
     async ping() {
         try {
-            const response = await fetch(`${this.baseURL}/api/graph`);
+            const response = await fetch(`${this.baseURL}/api/metrics`);
             return response.ok;
         } catch (error) {
             return false;
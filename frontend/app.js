@@ -7,11 +7,19 @@ class CampusNavigatorApp {
     constructor() {
         this.currentAlgorithm = null;
         this.steps = [];
+        this.route = null; // path of an untraced route, drawn over tiled graphs
         this.currentStep = 0;
         this.isPlaying = false;
         this.playInterval = null;
         this.speed = 1000;
         this.graphData = null;
+        this.nextPickIsEnd = false;
+        this.landmarks = false; // whether the campus has ALT landmark tables
+        this.fullGraphLimit = 2000; // above this many nodes, load the tiled overview
+        this.syncInterval = 10000; // ms between checks for graph changes
+        this.tileDelay = 200; // ms after the last pan or zoom before tiles are fetched
+        this.tileTimer = null;
+        this.tileRequest = 0; // newest tile request; older answers are dropped
         
         // Pseudocode templates
         this.pseudocodes = {
@@ -34,6 +42,75 @@ class CampusNavigatorApp {
                 previous[v] = u
     
     return dist, previous`,
+
+            astar: `function astar(graph, start, end):
+    dist[start] = 0
+    for each vertex v:
+        if v ≠ start:
+            dist[v] = ∞
+    
+    // h(v) = straight-line distance to end,
+    // scaled so it never overestimates
+    Q = priority queue ordered by dist + h
+    
+    while Q is not empty:
+        u = vertex with min dist[u] + h(u) in Q
+        remove u from Q
+        if u == end: stop
+        
+        for each neighbor v of u:
+            alt = dist[u] + weight(u, v)
+            if alt < dist[v]:
+                dist[v] = alt
+                previous[v] = u
+    
+    return dist, previous`,
+
+            alt: `function alt(graph, start, end, landmarks):
+    dist[start] = 0
+    for each vertex v:
+        if v ≠ start:
+            dist[v] = ∞
+    
+    // d(v, L) precomputed for every landmark L;
+    // triangle inequality: d(v, end) ≥ |d(v, L) - d(end, L)|
+    h(v) = max over L of |d(v, L) - d(end, L)|
+    Q = priority queue ordered by dist + h
+    
+    while Q is not empty:
+        u = vertex with min dist[u] + h(u) in Q
+        remove u from Q
+        if u == end: stop
+        
+        for each neighbor v of u:
+            alt = dist[u] + weight(u, v)
+            if alt < dist[v]:
+                dist[v] = alt
+                previous[v] = u
+    
+    return dist, previous`,
+
+            bidirectional: `function bidirectional(graph, start, end):
+    distF[start] = 0, distB[end] = 0
+    QF = {start}, QB = {end}
+    best = ∞
+    
+    while QF and QB are not empty:
+        if min(QF) + min(QB) ≥ best:
+            stop  // no shorter path left
+        
+        side = queue with the smaller minimum
+        u = remove min from side's queue
+        
+        for each neighbor v of u:
+            alt = dist[side][u] + weight(u, v)
+            if alt < dist[side][v]:
+                dist[side][v] = alt
+                previous[side][v] = u
+            if the other side has reached v:
+                best = min(best, distF[v] + distB[v])
+    
+    return best`,
             
             search: `function binarySearch(array, target):
     left = 0
@@ -116,7 +193,12 @@ class CampusNavigatorApp {
             // Try to load from backend
             const isRunning = await api.ping();
             if (isRunning) {
-                this.graphData = await api.getGraph();
+                // Large graphs start from the coarse tiled overview instead of every node
+                const metrics = await api.getMetrics();
+                this.landmarks = Boolean(metrics.landmarks);
+                this.graphData = metrics.nodes > this.fullGraphLimit
+                    ? await api.getGraphTiles(null, 0)
+                    : await api.getGraph();
             } else {
                 // Use fallback data so the UI still works
                 this.graphData = this.getFallbackGraphData();
@@ -130,8 +212,88 @@ class CampusNavigatorApp {
 
         // Populate dropdowns and draw canvas with whatever data we have
         visualizer.setGraphData(this.graphData);
+        visualizer.onViewportChange = () => this.onViewportChange();
         this.populateNodeSelectors();
+        this.updateRouteAlgorithms();
         this.showStatus('Ready! Select an algorithm to begin.');
+
+        // Full graphs are kept current from the change journal; tiles revalidate by ETag
+        if (this.graphData.version !== undefined && !this.graphData.grid) {
+            setInterval(() => this.syncGraph(), this.syncInterval);
+        }
+    }
+
+    // Redraw whatever is on screen: the current step, or the graph with any route
+    redraw() {
+        if (this.steps.length > 0) {
+            this.displayCurrentStep();
+        } else {
+            visualizer.draw();
+            visualizer.highlightPath(this.route);
+        }
+    }
+
+    // After a pan or zoom; tiled graphs then load the tiles for the new view
+    onViewportChange() {
+        this.redraw();
+        if (this.graphData && this.graphData.grid) {
+            clearTimeout(this.tileTimer);
+            this.tileTimer = setTimeout(() => this.loadVisibleTiles(), this.tileDelay);
+        }
+    }
+
+    // The tiles covering the view, at the zoom level that puts about two tiles across it
+    async loadVisibleTiles() {
+        const view = visualizer.visibleBounds();
+        const grid = this.graphData.grid;
+        const span = Math.max(view.maxX - view.minX, view.maxY - view.minY);
+        const zoom = Math.min(grid.maxZoom, Math.max(0, Math.round(Math.log2(2 * grid.extent / span))));
+        const request = ++this.tileRequest;
+        let tiles;
+        try {
+            tiles = await api.getGraphTiles([view.minX, view.minY, view.maxX, view.maxY], zoom);
+        } catch (error) {
+            return; // keep showing what we have
+        }
+        if (request !== this.tileRequest) return;
+        this.graphData = tiles;
+        visualizer.graphData = tiles;
+        this.redraw();
+    }
+
+    // Apply the server's changes since our graph version
+    async syncGraph() {
+        let delta;
+        try {
+            delta = await api.getGraphChanges(this.graphData.version);
+        } catch (error) {
+            return; // backend unreachable; try again next interval
+        }
+        if (delta.version === this.graphData.version) return;
+
+        if (delta.full) {
+            this.graphData = delta;
+        } else {
+            const graph = this.graphData;
+            const position = new Map(graph.edges.map((edge, i) => [edge.id, i]));
+            delta.edges.modified.forEach(edge => { graph.edges[position.get(edge.id)] = edge; });
+            graph.edges.push(...delta.edges.added);
+            if (delta.edges.removed.length > 0) {
+                const removed = new Set(delta.edges.removed);
+                graph.edges = graph.edges.filter(edge => !removed.has(edge.id));
+            }
+            [...delta.nodes.added, ...delta.nodes.modified].forEach(node => { graph.nodes[node.id] = node; });
+            delta.nodes.removed.forEach(id => { delete graph.nodes[id]; });
+            graph.componentCount = delta.componentCount;
+            graph.version = delta.version;
+        }
+
+        // Keep the viewport while a route is on screen; the next redraw picks the changes up
+        if (this.steps.length > 0) {
+            visualizer.graphData = this.graphData;
+        } else {
+            visualizer.setGraphData(this.graphData);
+        }
     }
 
     // Setup event listeners
@@ -154,6 +316,11 @@ class CampusNavigatorApp {
             if (e.key === 'Enter') this.loadSearch();
         });
 
+        // Click on the map to pick route endpoints
+        document.getElementById('main-canvas').addEventListener('click', (e) => {
+            this.onCanvasClick(e);
+        });
+
         // Tab switching (Explanation / Code tabs in right sidebar)
         document.querySelectorAll('.tab-btn').forEach(btn => {
             btn.addEventListener('click', () => {
@@ -188,6 +355,42 @@ class CampusNavigatorApp {
         document.getElementById('sort-reference').value = 0;
     }
 
+    // Select the node nearest to a click as route start, then end (alternating)
+    async onCanvasClick(event) {
+        if (document.getElementById('algo-select').value !== 'dijkstra' || !this.graphData) return;
+
+        const point = visualizer.toGraphCoordinates(event);
+        let node = null;
+        try {
+            const data = await api.getNearest(point.x, point.y, 1);
+            node = data.nodes[0];
+        } catch (error) {
+            // Offline: the fallback graph is small enough to scan
+            let best = Infinity;
+            this.graphData.nodes.forEach(n => {
+                const d = Math.hypot(n.x - point.x, n.y - point.y);
+                if (d < best) {
+                    best = d;
+                    node = n;
+                }
+            });
+        }
+        if (!node) return;
+
+        const selectorId = this.nextPickIsEnd ? 'end-node' : 'start-node';
+        document.getElementById(selectorId).value = node.id;
+        this.showStatus(`${this.nextPickIsEnd ? 'To' : 'From'}: ${node.name}`);
+        this.nextPickIsEnd = !this.nextPickIsEnd;
+    }
+
+    // ALT needs landmark tables, which a campus only has when the server was given some
+    updateRouteAlgorithms() {
+        const select = document.getElementById('route-algorithm');
+        const alt = select.querySelector('option[value="alt"]');
+        alt.disabled = alt.hidden = !this.landmarks;
+        if (!this.landmarks && select.value === 'alt') select.value = 'dijkstra';
+    }
+
     // Handle algorithm selection change
     onAlgorithmChange(algorithm) {
         // Hide all option panels by removing 'active' class
@@ -226,6 +429,8 @@ class CampusNavigatorApp {
         try {
             const start = parseInt(document.getElementById('start-node').value);
             const end = parseInt(document.getElementById('end-node').value);
+            const profile = document.getElementById('route-profile').value;
+            const algorithm = document.getElementById('route-algorithm').value;
             
             if (start === end) {
                 alert('Start and end nodes must be different!');
@@ -234,21 +439,31 @@ class CampusNavigatorApp {
             
             this.showStatus('Finding shortest path...');
             
-            const data = await api.getDijkstra(start, end);
+            // Traces grow with the square of the graph, so tiled graphs only get the path
+            const tiled = Boolean(this.graphData && this.graphData.grid);
+            const data = await api.getDijkstra(start, end, profile, algorithm, tiled ? 'none' : 'full');
             
             this.currentAlgorithm = 'dijkstra';
-            this.steps = data.steps;
+            this.steps = data.steps || [];
+            this.route = tiled ? data.path : null;
             this.currentStep = 0;
             
             // Update UI
-            this.updatePseudocode('dijkstra');
+            this.updatePseudocode(data.algorithm);
             this.updateComplexity(data.complexity);
             this.updateStepCounter();
             
-            // Show first step
-            this.displayCurrentStep();
+            // Show first step, or the whole path when there is no trace to play
+            this.redraw();
             
-            this.showStatus(`Found path! Distance: ${data.distance}m`);
+            if (data.distance < 0) {
+                this.showStatus(`No ${data.profile} route between these locations`);
+            } else {
+                // Settled nodes and search time make Dijkstra and A* easy to compare;
+                // replies from the server's route cache carry no search time
+                const time = data.cached ? 'cached' : `in ${(data.searchMicros / 1000).toFixed(1)} ms`;
+                this.showStatus(`Found path! Distance: ${data.distance}m (${data.settled} nodes settled, ${time})`);
+            }
             
         } catch (error) {
             this.showError('Error loading Dijkstra: ' + error.message);
@@ -271,6 +486,7 @@ class CampusNavigatorApp {
             
             this.currentAlgorithm = 'search';
             this.steps = data.steps;
+            this.route = null;
             this.currentStep = 0;
             this.sortedNodes = data.sortedArray;
             
@@ -305,6 +521,7 @@ class CampusNavigatorApp {
             
             this.currentAlgorithm = 'sort';
             this.steps = data.steps;
+            this.route = null;
             this.currentStep = 0;
             
             // Update UI
@@ -338,7 +555,11 @@ class CampusNavigatorApp {
         // Update visualization based on algorithm
         switch (this.currentAlgorithm) {
             case 'dijkstra':
-                visualizer.drawDijkstraStep(step);
+                if (step.backwardVisited) {
+                    visualizer.drawBidirectionalStep(step);
+                } else {
+                    visualizer.drawDijkstraStep(step);
+                }
                 this.updateDijkstraStats(step);
                 break;
             
@@ -357,12 +578,14 @@ class CampusNavigatorApp {
 
     // Update statistics for Dijkstra
     updateDijkstraStats(step) {
-        const visited = step.visited ? step.visited.filter(v => v).length : 0;
+        const settled = visited => visited ? visited.filter(v => v).length : 0;
+        const visited = settled(step.visited) + settled(step.backwardVisited);
         document.getElementById('stat-nodes').textContent = visited;
         document.getElementById('stat-comparisons').textContent = step.step;
         
-        const currentDist = step.distances && step.node >= 0 
-            ? step.distances[step.node] 
+        const distances = step.direction === 'backward' ? step.backwardDistances : step.distances;
+        const currentDist = distances && step.node >= 0 
+            ? distances[step.node] 
             : 'N/A';
         document.getElementById('stat-distance').textContent = 
             currentDist !== -1 ? currentDist + 'm' : 'N/A';
@@ -483,7 +706,7 @@ class CampusNavigatorApp {
         if (this.steps.length > 0) {
             this.displayCurrentStep();
         } else {
-            visualizer.draw();
+            this.redraw();
             document.getElementById('explanation-text').textContent = 
                 'Select an algorithm to begin visualization.';
         }
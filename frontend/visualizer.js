@@ -24,6 +24,7 @@ class Visualizer {
         this.colors = {
             unvisited: '#0b0144',
             visited: '#4CAF50',
+            visitedBackward: '#2196F3',
             current: '#FFC107',
             target: '#F44336',
             path: '#9C27B0',
@@ -39,6 +40,77 @@ class Visualizer {
         // Font settings
         this.font = '14px Arial';
         this.boldFont = 'bold 14px Arial';
+
+        // Called after the user pans or zooms; redraws the plain graph if unset
+        this.onViewportChange = null;
+        this.dragStart = null;
+        this.dragged = false;
+        this.setupPanZoom();
+    }
+
+    // Drag to pan, wheel to zoom around the cursor
+    setupPanZoom() {
+        const canvasPoint = (event) => {
+            const rect = this.canvas.getBoundingClientRect();
+            return {
+                x: (event.clientX - rect.left) * (this.canvas.width / rect.width),
+                y: (event.clientY - rect.top) * (this.canvas.height / rect.height)
+            };
+        };
+
+        this.canvas.addEventListener('mousedown', (e) => {
+            this.dragStart = canvasPoint(e);
+            this.dragged = false;
+        });
+        window.addEventListener('mousemove', (e) => {
+            if (!this.dragStart) return;
+            const point = canvasPoint(e);
+            const dx = point.x - this.dragStart.x, dy = point.y - this.dragStart.y;
+            if (!this.dragged && Math.hypot(dx, dy) < 4) return;
+            this.dragged = true;
+            this.offsetX += dx;
+            this.offsetY += dy;
+            this.dragStart = point;
+            this.viewportChanged();
+        });
+        window.addEventListener('mouseup', () => { this.dragStart = null; });
+
+        // A drag ends with a click on the canvas; it should not pick a node
+        this.canvas.addEventListener('click', (e) => {
+            if (this.dragged) {
+                e.stopImmediatePropagation();
+                this.dragged = false;
+            }
+        }, true);
+
+        this.canvas.addEventListener('wheel', (e) => {
+            if (!this.graphData) return;
+            e.preventDefault();
+            const point = canvasPoint(e);
+            const factor = e.deltaY < 0 ? 1.25 : 0.8;
+            this.offsetX = point.x - (point.x - this.offsetX) * factor;
+            this.offsetY = point.y - (point.y - this.offsetY) * factor;
+            this.scale *= factor;
+            this.viewportChanged();
+        }, { passive: false });
+    }
+
+    viewportChanged() {
+        if (this.onViewportChange) {
+            this.onViewportChange();
+        } else {
+            this.draw();
+        }
+    }
+
+    // The part of the graph on the canvas, in graph coordinates
+    visibleBounds() {
+        return {
+            minX: -this.offsetX / this.scale,
+            minY: -this.offsetY / this.scale,
+            maxX: (this.canvas.width - this.offsetX) / this.scale,
+            maxY: (this.canvas.height - this.offsetY) / this.scale
+        };
     }
 
     // Calculate optimal scale and offset to fit all nodes in canvas
@@ -104,6 +176,25 @@ class Visualizer {
         return y * this.scale + this.offsetY;
     }
 
+    // Convert a mouse event on the canvas to graph coordinates
+    toGraphCoordinates(event) {
+        const rect = this.canvas.getBoundingClientRect();
+        const canvasX = (event.clientX - rect.left) * (this.canvas.width / rect.width);
+        const canvasY = (event.clientY - rect.top) * (this.canvas.height / rect.height);
+        return {
+            x: (canvasX - this.offsetX) / this.scale,
+            y: (canvasY - this.offsetY) / this.scale
+        };
+    }
+
+    // Outline colour for a node: white, or one hue per connected component when the graph is split
+    componentColor(node) {
+        if (!this.graphData.componentCount || this.graphData.componentCount < 2 || node.component === undefined) {
+            return '#FFFFFF';
+        }
+        return `hsl(${(node.component * 137) % 360}, 70%, 50%)`;
+    }
+
     // Set graph data
     setGraphData(data) {
         this.graphData = data;
@@ -131,8 +222,8 @@ class Visualizer {
         const edges = this.graphData.edges;
         
         edges.forEach(edge => {
-            const fromNode = nodes.find(n => n.id === edge.from);
-            const toNode = nodes.find(n => n.id === edge.to);
+            const fromNode = nodes[edge.from];
+            const toNode = nodes[edge.to];
             
             if (!fromNode || !toNode) return;
             
@@ -153,7 +244,10 @@ class Visualizer {
             ctx.lineTo(x2, y2);
             ctx.strokeStyle = isHighlighted ? this.colors.edgeHighlight : this.colors.edge;
             ctx.lineWidth = isHighlighted ? 4 : 2;
+            // Closed paths are drawn dashed
+            ctx.setLineDash(edge.closed ? [8, 6] : []);
             ctx.stroke();
+            ctx.setLineDash([]);
             
             // Draw weight label
             const midX = (x1 + x2) / 2;
@@ -171,7 +265,7 @@ class Visualizer {
     }
 
     //Draw all nodes
-    drawNodes(visitedNodes = [], currentNode = -1, targetNode = -1, distances = []) {
+    drawNodes(visitedNodes = [], currentNode = -1, targetNode = -1, distances = [], backwardVisited = []) {
         const ctx = this.ctx;
         const nodes = this.graphData.nodes;
         
@@ -191,6 +285,8 @@ class Visualizer {
                 color = this.colors.target;
             } else if (visitedNodes[node.id]) {
                 color = this.colors.visited;
+            } else if (backwardVisited[node.id]) {
+                color = this.colors.visitedBackward;
             }
             
             // Draw node circle
@@ -198,7 +294,7 @@ class Visualizer {
             ctx.arc(x, y, radius, 0, Math.PI * 2);
             ctx.fillStyle = color;
             ctx.fill();
-            ctx.strokeStyle = '#FFFFFF';
+            ctx.strokeStyle = this.componentColor(node);
             ctx.lineWidth = 3;
             ctx.stroke();
             
@@ -250,6 +346,23 @@ class Visualizer {
         );
     }
 
+    // Draw a bidirectional search step: forward frontier green, backward frontier blue.
+    // Each node shows its distance from whichever end has reached it.
+    drawBidirectionalStep(step) {
+        this.clear();
+
+        const highlightEdges = [];
+        [step.previous, step.backwardPrevious].forEach(previous => {
+            previous.forEach((prev, nodeId) => {
+                if (prev !== -1) highlightEdges.push({ from: prev, to: nodeId });
+            });
+        });
+        const distances = step.distances.map((d, i) => d !== -1 ? d : step.backwardDistances[i]);
+
+        this.drawEdges(highlightEdges);
+        this.drawNodes(step.visited, step.node, step.meeting, distances, step.backwardVisited);
+    }
+
     //Draw search step (binary search)
     drawSearchStep(step, sortedNodes) {
     this.clear();
@@ -481,9 +594,12 @@ class Visualizer {
     }
     }
 
-    // Highlight final path
+    // Highlight final path. On a tiled graph only the path nodes of the loaded
+    // tiles are known, so the line runs through those.
     highlightPath(path) {
-        if (!path || path.length === 0) return;
+        if (!path) return;
+        path = path.filter(nodeId => this.graphData.nodes[nodeId]);
+        if (path.length === 0) return;
         
         const ctx = this.ctx;
         